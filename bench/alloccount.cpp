@@ -0,0 +1,26 @@
+#include "alloccount.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// The replacements live in their own file so they are never inlined into a caller. GCC otherwise sees
+// std::free() meet a pointer from operator new and warns with -Wmismatched-new-delete.
+static std::atomic<uint64_t> allocations = { 0 };
+
+void* operator new(size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr); }
+
+namespace Cdecl {
+	namespace Bench {
+		uint64_t AllocationCount() {
+			return allocations.load(std::memory_order_relaxed);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+
+namespace Cdecl {
+	namespace Bench {
+		/*
+		 * Allocations through the global operator new so far, counted by the replacement in alloccount.cpp.
+		 * Every allocation in the process is counted, so this includes the library's and the STL's.
+		 */
+		uint64_t AllocationCount();
+	}
+}
\ No newline at end of file
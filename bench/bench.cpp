@@ -0,0 +1,367 @@
+#include <cdecl/c/emit.hpp>
+#include <cdecl/c/incremental.hpp>
+#include <cdecl/c/lexer.hpp>
+#include <cdecl/c/syntax.hpp>
+#include <cdecl/c/tokendefs.hpp>
+#include <cdecl/c/typedb.hpp>
+#include <cdecl/c/typetable.hpp>
+#include <cdecl/stringcursor.hpp>
+#include <cdecl/parsestats.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include "alloccount.hpp"
+#include "corpus.hpp"
+
+using namespace Cdecl;
+using namespace Cdecl::Bench;
+
+static_assert(std::is_same<char_t, char>::value, "The benchmark corpus is narrow text");
+
+// What one pass over the corpus processed
+struct Work {
+	size_t items = 0;
+	size_t tokens = 0;
+	size_t bytes = 0;
+	size_t sink = 0; // Folded from results so passes aren't optimized away
+};
+
+struct Options {
+	CorpusOptions corpus;
+	size_t repeat = 5;
+	bool dump = false;
+};
+
+static volatile size_t sink;
+
+// Runs `pass` `repeat` times and reports the fastest
+template <class TPass>
+static void Run(const char* name, const char* unit, size_t repeat, TPass pass) {
+	double best = 0;
+	uint64_t allocs = 0;
+	ParseStats stats;
+	Work work;
+
+	for (size_t i = 0; i < repeat; ++i) {
+		uint64_t allocs_before = AllocationCount();
+		ParseStats stats_before = ParseStats::Local();
+		auto begin = std::chrono::steady_clock::now();
+		work = pass();
+		auto end = std::chrono::steady_clock::now();
+
+		double seconds = std::chrono::duration<double>(end - begin).count();
+		if (i == 0 || seconds < best) {
+			best = seconds;
+			allocs = AllocationCount() - allocs_before;
+			stats = ParseStats::Local() - stats_before;
+		}
+		sink = sink + work.sink;
+	}
+
+	double items = (double)work.items;
+	double rate = items / best;
+	bool mega = rate >= 1e6;
+
+	char tokens[32] = "-";
+	if (work.tokens)
+		std::snprintf(tokens, sizeof(tokens), "%.2f", work.tokens / best / 1e6);
+	char bytes[32] = "-";
+	if (work.bytes)
+		std::snprintf(bytes, sizeof(bytes), "%.1f", work.bytes / best / 1e6);
+
+	std::printf("%-32s %10.2f %s%s/s %10s Mtok/s %9s MB/s %9.1f ns/%s %8.2f allocs/%s\n",
+		name, rate / (mega ? 1e6 : 1e3), mega ? "M" : "k", unit, tokens, bytes,
+		best * 1e9 / items, unit, allocs / items, unit);
+
+	if (ParseStats::enabled && (stats.tokens || stats.phase_ns[ParseStats::Parse])) {
+		std::printf("%-32s %10.2f tok/%s %8.2f defs/tok %8.2f backtracks/%s %8.2f nodes/%s %8.2f errors/%s %8.1f lex ms %8.1f parse ms\n",
+			"", stats.tokens / items, unit, stats.tokens ? (double)stats.defs_tried / stats.tokens : 0.0,
+			stats.backtracks / items, unit, stats.allocations / items, unit, stats.errors / items, unit,
+			stats.phase_ns[ParseStats::Lex] / 1e6, stats.phase_ns[ParseStats::Parse] / 1e6);
+	}
+}
+
+static bool ParseArgs(int argc, char** argv, Options& options) {
+	for (int i = 1; i < argc; ++i) {
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+		if (!std::strcmp(arg, "--dump")) {
+			options.dump = true;
+			continue;
+		}
+		if (!value)
+			return false;
+
+		if (!std::strcmp(arg, "--seed"))
+			options.corpus.seed = std::strtoull(value, nullptr, 10);
+		else if (!std::strcmp(arg, "--count"))
+			options.corpus.count = std::strtoull(value, nullptr, 10);
+		else if (!std::strcmp(arg, "--max-args"))
+			options.corpus.max_args = std::strtoull(value, nullptr, 10);
+		else if (!std::strcmp(arg, "--max-depth"))
+			options.corpus.max_pointer_depth = std::strtoull(value, nullptr, 10);
+		else if (!std::strcmp(arg, "--repeat"))
+			options.repeat = std::max<size_t>(1, std::strtoull(value, nullptr, 10));
+		else
+			return false;
+		++i;
+	}
+	return true;
+}
+
+static std::vector<TokenBuffer> Lex(const std::vector<std::string>& strs, size_t& tokens) {
+	std::vector<TokenBuffer> buffers;
+	buffers.reserve(strs.size());
+	tokens = 0;
+
+	for (const std::string& str : strs) {
+		Lexer::ParseBufferResult result = Lexer::ParseBuffer(str);
+		if (!result) {
+			std::fprintf(stderr, "Corpus failed to lex: %s\n", result.GetErr().c_str());
+			std::exit(1);
+		}
+		buffers.push_back(result.GetOk());
+		tokens += buffers.back().Size();
+	}
+	return buffers;
+}
+
+int main(int argc, char** argv) {
+	Options options;
+	if (!ParseArgs(argc, argv, options)) {
+		std::fprintf(stderr, "Usage: %s [--seed N] [--count N] [--max-args N] [--max-depth N] [--repeat N] [--dump]\n", argv[0]);
+		return 2;
+	}
+
+	Corpus corpus = GenerateCorpus(options.corpus);
+	if (options.dump) {
+		std::fwrite(corpus.text.data(), 1, corpus.text.size(), stdout);
+		return 0;
+	}
+
+	size_t decl_tokens, type_tokens;
+	std::vector<TokenBuffer> decl_buffers = Lex(corpus.decls, decl_tokens);
+	std::vector<TokenBuffer> type_buffers = Lex(corpus.types, type_tokens);
+
+	size_t decl_bytes = 0, type_bytes = 0;
+	for (const std::string& decl : corpus.decls)
+		decl_bytes += decl.size();
+	for (const std::string& type : corpus.types)
+		type_bytes += type.size();
+
+	// Every decl must parse, or the numbers below measure error paths
+	for (size_t i = 0; i < decl_buffers.size(); ++i) {
+		FunctionProto::ParseResult result = FunctionProto::Parse(TokenCursor(decl_buffers[i]));
+		if (!result) {
+			std::fprintf(stderr, "Corpus failed to parse: %s\n  %s\n", corpus.decls[i].c_str(), result.GetErr().Render(decl_buffers[i]).c_str());
+			return 1;
+		}
+	}
+
+	std::printf("seed %llu: %zu decls, %zu types, %zu tokens, %zu bytes\n\n",
+		(unsigned long long)options.corpus.seed, corpus.decls.size(), corpus.types.size(), decl_tokens, decl_bytes);
+
+	const string_view text = corpus.text;
+
+	Run("StringCursor::Skip", "char", options.repeat, [&]() {
+		Work work;
+		StringCursor cur = StringCursor(text);
+		while (const char_t* ch = cur.Skip())
+			work.sink += *ch;
+		work.items = work.bytes = text.length();
+		return work;
+	});
+
+	Run("StringCursor::MatchChar", "char", options.repeat, [&]() {
+		Work work;
+		StringCursor cur = StringCursor(text);
+		while (cur.Peek()) {
+			cur.SkipWhitespace();
+			if (cur.MatchChar('*') || cur.MatchChar('(') || cur.MatchChar(')') || cur.MatchChar(','))
+				++work.sink;
+			else
+				cur.Skip();
+		}
+		work.items = work.bytes = text.length();
+		return work;
+	});
+
+	Run("StringCursor::MatchString", "char", options.repeat, [&]() {
+		Work work;
+		StringCursor cur = StringCursor(text);
+		while (cur.Peek()) {
+			if (cur.MatchString("const") || cur.MatchString("unsigned") || cur.MatchString("__stdcall"))
+				++work.sink;
+			else
+				cur.Skip();
+		}
+		work.items = work.bytes = text.length();
+		return work;
+	});
+
+	Run("Tokenizer::ParseAll", "decl", options.repeat, [&]() {
+		Work work;
+		for (const std::string& decl : corpus.decls) {
+			Tokenizer::ParseResult result = tokenizer.ParseAll(decl);
+			work.tokens += result.GetOk().size();
+		}
+		work.items = corpus.decls.size();
+		work.bytes = decl_bytes;
+		work.sink = work.tokens;
+		return work;
+	});
+
+	Run("Lexer::ParseAll", "decl", options.repeat, [&]() {
+		Work work;
+		for (const std::string& decl : corpus.decls) {
+			Lexer::ParseResult result = Lexer::ParseAll(decl);
+			work.tokens += result.GetOk().size();
+		}
+		work.items = corpus.decls.size();
+		work.bytes = decl_bytes;
+		work.sink = work.tokens;
+		return work;
+	});
+
+	// Each decl is lexed into the storage of the previous one's buffer
+	Run("Lexer::ParseBuffer", "decl", options.repeat, [&]() {
+		Work work;
+		TokenBuffer buffer;
+		for (const std::string& decl : corpus.decls) {
+			Lexer::ParseBufferResult result = Lexer::ParseBuffer(decl, std::move(buffer));
+			buffer = result.TakeOk();
+			work.tokens += buffer.Size();
+		}
+		work.items = corpus.decls.size();
+		work.bytes = decl_bytes;
+		work.sink = work.tokens;
+		return work;
+	});
+
+	Run("Type::Parse", "type", options.repeat, [&]() {
+		Work work;
+		for (const TokenBuffer& tokens : type_buffers) {
+			Type::ParseResult result = Type::Parse(TokenCursor(tokens), ParseMaskBlacklist());
+			work.sink += result.IsOk();
+		}
+		work.items = type_buffers.size();
+		work.tokens = type_tokens;
+		work.bytes = type_bytes;
+		return work;
+	});
+
+	Run("FunctionProto::Parse", "decl", options.repeat, [&]() {
+		Work work;
+		for (const TokenBuffer& tokens : decl_buffers) {
+			FunctionProto::ParseResult result = FunctionProto::Parse(TokenCursor(tokens));
+			work.sink += result.IsOk();
+		}
+		work.items = decl_buffers.size();
+		work.tokens = decl_tokens;
+		work.bytes = decl_bytes;
+		return work;
+	});
+
+	// Shares one table across passes, so this measures the steady state where every type is already interned
+	TypeTable types;
+	ParseContext interned;
+	interned.types = &types;
+	Run("FunctionProto::Parse (TypeTable)", "decl", options.repeat, [&]() {
+		Work work;
+		for (const TokenBuffer& tokens : decl_buffers) {
+			FunctionProto::ParseResult result = FunctionProto::Parse(TokenCursor(tokens), interned);
+			work.sink += result.IsOk();
+		}
+		work.items = decl_buffers.size();
+		work.tokens = decl_tokens;
+		work.bytes = decl_bytes;
+		return work;
+	});
+
+	Run("Lex + FunctionProto::Parse", "decl", options.repeat, [&]() {
+		Work work;
+		for (const std::string& decl : corpus.decls) {
+			Lexer::ParseBufferResult lexed = Lexer::ParseBuffer(decl);
+			FunctionProto::ParseResult result = FunctionProto::Parse(TokenCursor(lexed.GetOk()));
+			work.sink += result.IsOk();
+			work.tokens += lexed.GetOk().Size();
+		}
+		work.items = corpus.decls.size();
+		work.bytes = decl_bytes;
+		return work;
+	});
+
+	Run("IncrementalParser (full parse)", "decl", options.repeat, [&]() {
+		Work work;
+		IncrementalParser parser = IncrementalParser(corpus.text);
+		work.items = parser.GetDecls().size();
+		work.bytes = corpus.text.size();
+		return work;
+	});
+
+	// Types a char into a name and deletes it again, at decls spread over the whole buffer
+	std::vector<size_t> edit_offsets;
+	const size_t edit_count = std::min<size_t>(1000, corpus.decls.size());
+	for (size_t i = 0, offset = 0, decl = 0; i < edit_count; ++i) {
+		for (size_t target = i * corpus.decls.size() / edit_count; decl < target; ++decl)
+			offset = corpus.text.find('\n', offset) + 1;
+		edit_offsets.push_back(corpus.text.find('(', offset));
+	}
+
+	IncrementalParser editor = IncrementalParser(corpus.text);
+	Run("IncrementalParser::Edit", "edit", options.repeat, [&]() {
+		Work work;
+		for (size_t offset : edit_offsets) {
+			IncrementalParser::EditResult inserted = editor.Edit(offset, 0, "x");
+			IncrementalParser::EditResult removed = editor.Edit(offset, 1, string_view());
+			work.sink += inserted.inserted + removed.inserted;
+		}
+		work.items = edit_offsets.size() * 2;
+		return work;
+	});
+
+	std::vector<FunctionProto> protos;
+	protos.reserve(decl_buffers.size());
+	for (const TokenBuffer& buffer : decl_buffers)
+		protos.push_back(std::get<FunctionProto>(FunctionProto::Parse(TokenCursor(buffer)).GetOk()));
+
+	Run("EmitFunctionProtos", "decl", options.repeat, [&]() {
+		Work work;
+		string out;
+		EmitFunctionProtos(protos, out);
+		work.items = protos.size();
+		work.bytes = out.size();
+		work.sink = out.size();
+		return work;
+	});
+
+	TypeDbWriter writer;
+	for (const FunctionProto& proto : protos)
+		writer.Add(proto);
+	const std::string db_path = (std::filesystem::temp_directory_path() / "cdecl_bench.typedb").string();
+	if (std::optional<string> err = writer.Save(db_path.c_str())) {
+		std::fprintf(stderr, "%s\n", err->c_str());
+		return 1;
+	}
+	const size_t db_size = std::filesystem::file_size(db_path);
+
+	// Maps the file, so this is the cost of opening a database that is already in the page cache
+	auto open_db = [&](size_t opens, bool verify) {
+		Work work;
+		for (size_t i = 0; i < opens; ++i) {
+			TypeDb::OpenResult db = TypeDb::Open(db_path.c_str(), verify);
+			work.sink += db ? db.GetOk()->ProtoCount() : 0;
+		}
+		work.items = opens;
+		work.bytes = verify ? db_size * opens : 0;
+		return work;
+	};
+	Run("TypeDb::Open", "open", options.repeat, [&]() { return open_db(1000, false); });
+	Run("TypeDb::Open (verify)", "open", options.repeat, [&]() { return open_db(10, true); });
+	std::filesystem::remove(db_path);
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include "corpus.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace Cdecl {
+	namespace Bench {
+		// SplitMix64. std:: distributions differ between standard libraries, so they can't be used for a stable corpus.
+		class Rng {
+			uint64_t m_state;
+
+		public:
+			Rng(uint64_t seed) : m_state(seed) {}
+
+			uint64_t Next() {
+				uint64_t z = (m_state += 0x9e3779b97f4a7c15ull);
+				z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+				z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+				return z ^ (z >> 31);
+			}
+
+			size_t Below(size_t n) { return n ? (size_t)(Next() % n) : 0; }
+			bool Chance(double p) { return (Next() >> 11) * (1.0 / 9007199254740992.0) < p; }
+
+			template <class T, size_t N>
+			const T& Pick(const T(&items)[N]) { return items[Below(N)]; }
+		};
+
+		// Specifier words of each base type, in canonical order. Weighted by repetition.
+		static const std::vector<const char*> base_types[] = {
+			{ "int" }, { "int" }, { "int" }, { "int" },
+			{ "char" }, { "char" }, { "unsigned", "char" }, { "signed", "char" },
+			{ "short" }, { "unsigned", "short" }, { "short", "int" },
+			{ "long" }, { "unsigned", "long" }, { "unsigned", "long" }, { "long", "int" },
+			{ "long", "long" }, { "unsigned", "long", "long" },
+			{ "unsigned" }, { "unsigned", "int" },
+			{ "float" }, { "double" }, { "double" }, { "long", "double" },
+			{ "int8_t" }, { "int16_t" }, { "int32_t" }, { "int64_t" },
+			{ "uint8_t" }, { "uint16_t" }, { "uint32_t" }, { "uint32_t" }, { "uint64_t" }, { "uint64_t" },
+		};
+
+		static const char* const call_convs[] = { "__cdecl", "__stdcall", "__stdcall", "__fastcall", "__thiscall", "__vectorcall" };
+		static const char* const verbs[] = {
+			"Get", "Set", "Create", "Destroy", "Read", "Write", "Open", "Close", "Query", "Update", "Register", "Enum",
+		};
+		static const char* const nouns[] = {
+			"Window", "File", "Buffer", "Handle", "Device", "Context", "Stream", "Event", "Thread", "Module", "Key", "Value",
+		};
+		static const char* const arg_names[] = {
+			"hwnd", "buffer", "size", "count", "flags", "index", "ctx", "out", "name", "data", "length", "user_data",
+		};
+		static const char* const record_tags[] = { "_OVERLAPPED", "sockaddr", "timeval", "FILE_INFO", "Context", "Node" };
+
+		static void AppendWords(std::string& out, std::vector<const char*> words, Rng& rng, const CorpusOptions& options) {
+			if (words.size() > 1 && rng.Chance(options.shuffle_rate))
+				std::swap(words[0], words[words.size() - 1]);
+
+			for (size_t i = 0; i < words.size(); ++i) {
+				if (i)
+					out += ' ';
+				out += words[i];
+			}
+		}
+
+		// Mostly shallow, like real APIs: about half take no pointer at all
+		static size_t PointerDepth(Rng& rng, const CorpusOptions& options) {
+			size_t depth = 0;
+			while (depth < options.max_pointer_depth && rng.Chance(depth ? 0.25 : 0.5))
+				++depth;
+			return depth;
+		}
+
+		static std::string MakeType(Rng& rng, const CorpusOptions& options, bool is_return) {
+			std::string out;
+			size_t depth = PointerDepth(rng, options);
+
+			bool qualify = rng.Chance(options.qualifier_rate);
+			bool qualifier_first = rng.Chance(0.7);
+			const char* qualifier = rng.Chance(0.85) ? "const" : "volatile";
+			if (qualify && qualifier_first)
+				out += qualifier, out += ' ';
+
+			// void only appears as a pointee or a return type
+			size_t kind = rng.Below(20);
+			if (kind == 0 && (depth > 0 || is_return))
+				out += "void";
+			else if (kind == 1 && depth > 0)
+				out += "struct ", out += rng.Pick(record_tags);
+			else
+				AppendWords(out, rng.Pick(base_types), rng, options);
+
+			if (qualify && !qualifier_first)
+				out += ' ', out += qualifier;
+
+			for (size_t i = 0; i < depth; ++i) {
+				out += rng.Chance(0.8) ? "*" : " *";
+				if (rng.Chance(options.qualifier_rate / 2))
+					out += " const";
+			}
+			return out;
+		}
+
+		static std::string MakeName(Rng& rng, size_t index) {
+			std::string name = rng.Pick(verbs);
+			name += rng.Pick(nouns);
+			if (rng.Chance(0.3))
+				name += rng.Pick(nouns);
+			name += std::to_string(index);
+			return name;
+		}
+
+		Corpus GenerateCorpus(const CorpusOptions& options) {
+			Rng rng = Rng(options.seed);
+			Corpus corpus;
+			corpus.decls.reserve(options.count);
+
+			for (size_t i = 0; i < options.count; ++i) {
+				std::string decl = MakeType(rng, options, true);
+				corpus.types.push_back(decl);
+
+				if (rng.Chance(options.call_conv_rate))
+					decl += ' ', decl += rng.Pick(call_convs);
+				decl += ' ';
+				decl += MakeName(rng, i);
+				decl += '(';
+
+				// Skewed towards few arguments
+				size_t args = std::min(rng.Below(options.max_args + 1), rng.Below(options.max_args + 1));
+				if (args == 0 && rng.Chance(0.5))
+					decl += "void";
+
+				for (size_t a = 0; a < args; ++a) {
+					if (a)
+						decl += ", ";
+					std::string type = MakeType(rng, options, false);
+					decl += type;
+					corpus.types.push_back(std::move(type));
+
+					if (rng.Chance(0.85))
+						decl += ' ', decl += rng.Pick(arg_names);
+				}
+
+				if (args > 0 && rng.Chance(options.variadic_rate))
+					decl += ", ...";
+				decl += ')';
+
+				corpus.text += decl;
+				corpus.text += ";\n";
+				corpus.decls.push_back(std::move(decl));
+			}
+
+			return corpus;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Cdecl {
+	namespace Bench {
+		struct CorpusOptions {
+			uint64_t seed = 1;
+			size_t count = 50000; // Prototypes
+			size_t max_pointer_depth = 3;
+			size_t max_args = 8;
+			double call_conv_rate = 0.3;
+			double variadic_rate = 0.05;
+			double qualifier_rate = 0.25;
+			double shuffle_rate = 0.2; // Chance of writing specifiers out of canonical order, e.g. `long unsigned`
+		};
+
+		struct Corpus {
+			std::vector<std::string> decls; // Function prototypes, without ';'
+			std::vector<std::string> types; // Every return and argument type on its own
+			std::string text; // All decls, each followed by ";\n"
+		};
+
+		/*
+		 * Builds prototypes shaped like real API headers from a seed.
+		 * The generator is self-contained, so a seed gives the same corpus on every platform and standard library.
+		 */
+		Corpus GenerateCorpus(const CorpusOptions& options);
+	}
+}
\ No newline at end of file
@@ -1,8 +1,8 @@
-#include <iostream>
-#include <cdecl/c/primitive.hpp>
-
-int main() {
-
-
-	return 0;
+#include <iostream>
+#include <cdecl/c/primitive.hpp>
+
+int main() {
+
+
+	return 0;
 }
\ No newline at end of file
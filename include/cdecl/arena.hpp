@@ -0,0 +1,172 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+#include <type_traits>
+#include "util.hpp"
+
+namespace Cdecl {
+	/*
+	 * Bump allocator that owns everything allocated from it until Reset() or destruction.
+	 * Objects with destructors are finalized in reverse order on reset.
+	 *
+	 * MakeShared() hands out shared_ptrs that don't own their object and have no control block.
+	 * Copying them never touches a refcount, and they dangle after Reset(), like any arena pointer.
+	 * Not thread-safe. Use one arena per thread or per batch.
+	 */
+	class Arena {
+		struct Block {
+			std::unique_ptr<unsigned char[]> data;
+			size_t size;
+		};
+
+		struct Finalizer {
+			void (*destroy)(void*);
+			void* object;
+			Finalizer* next;
+		};
+
+		std::vector<Block> m_blocks;
+		size_t m_block = 0; // Index of the block being bumped
+		size_t m_used = 0; // Bytes used in that block
+		size_t m_block_size;
+		Finalizer* m_finalizers = nullptr;
+		std::vector<std::unique_ptr<Arena>> m_children;
+
+		void* AllocateSlow(size_t size, size_t align) {
+			// Move on to a reused block, or a new one big enough for this allocation
+			for (size_t next = m_blocks.empty() ? 0 : m_block + 1; next < m_blocks.size(); ++next) {
+				m_block = next;
+				m_used = 0;
+				if (void* ptr = TryAllocate(size, align))
+					return ptr;
+			}
+
+			size_t block_size = std::max(m_block_size, size + align);
+			m_blocks.push_back(Block{ std::unique_ptr<unsigned char[]>(new unsigned char[block_size]), block_size });
+			m_block = m_blocks.size() - 1;
+			m_used = 0;
+			return TryAllocate(size, align);
+		}
+
+		void* TryAllocate(size_t size, size_t align) {
+			Block& block = m_blocks[m_block];
+			uintptr_t base = (uintptr_t)block.data.get();
+			uintptr_t ptr = (base + m_used + align - 1) & ~(uintptr_t)(align - 1);
+			if (ptr + size > base + block.size)
+				return nullptr;
+			m_used = ptr + size - base;
+			return (void*)ptr;
+		}
+
+	public:
+		Arena(size_t block_size = 64 * 1024) : m_block_size(block_size) {}
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+		~Arena() { Reset(); }
+
+		void* Allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+			if (!m_blocks.empty()) {
+				if (void* ptr = TryAllocate(size, align))
+					return ptr;
+			}
+			return AllocateSlow(size, align);
+		}
+
+		template <class T, class ...TArgs>
+		T* New(TArgs&&... args) {
+			T* object = new (Allocate(sizeof(T), alignof(T))) T(std::forward<TArgs>(args)...);
+			if constexpr (!std::is_trivially_destructible_v<T>) {
+				Finalizer* finalizer = new (Allocate(sizeof(Finalizer), alignof(Finalizer))) Finalizer();
+				finalizer->destroy = [](void* ptr) { static_cast<T*>(ptr)->~T(); };
+				finalizer->object = (void*)object;
+				finalizer->next = m_finalizers;
+				m_finalizers = finalizer;
+			}
+			return object;
+		}
+
+		template <class T, class ...TArgs>
+		std::shared_ptr<T> MakeShared(TArgs&&... args) {
+			return std::shared_ptr<T>(std::shared_ptr<void>(), New<std::remove_const_t<T>>(std::forward<TArgs>(args)...));
+		}
+
+		// Copies str into the arena
+		string_view Copy(const string_view& str) {
+			char_t* copy = (char_t*)Allocate(str.length() * sizeof(char_t), alignof(char_t));
+			std::copy(str.begin(), str.end(), copy);
+			return string_view(copy, str.length());
+		}
+
+		/*
+		 * Returns the child arena at `index`, creating it on first use.
+		 * Children are reset and destroyed along with this arena, so each worker thread of a batch can allocate from
+		 * its own child while one Reset() still frees the whole batch. Creating children is not thread-safe.
+		 */
+		Arena& Child(size_t index) {
+			while (m_children.size() <= index)
+				m_children.push_back(std::unique_ptr<Arena>(new Arena(m_block_size)));
+			return *m_children[index];
+		}
+
+		// Destroys every object, here and in every child, and rewinds to the first block. Blocks are kept for reuse.
+		void Reset() {
+			for (Finalizer* finalizer = m_finalizers; finalizer; finalizer = finalizer->next)
+				finalizer->destroy(finalizer->object);
+			m_finalizers = nullptr;
+			m_block = 0;
+			m_used = 0;
+			for (std::unique_ptr<Arena>& child : m_children)
+				child->Reset();
+		}
+
+		size_t Capacity() const {
+			size_t capacity = 0;
+			for (const Block& block : m_blocks)
+				capacity += block.size;
+			return capacity;
+		}
+	};
+
+	/*
+	 * Allocator for containers held by arena nodes, e.g. argument lists. A null arena allocates from the heap.
+	 * Copies of a container allocate from the same arena as the original.
+	 */
+	template <class T>
+	class ArenaAllocator {
+		template <class> friend class ArenaAllocator;
+
+		Arena* m_arena;
+
+	public:
+		using value_type = T;
+
+		ArenaAllocator(Arena* arena = nullptr) noexcept : m_arena(arena) {}
+		template <class U>
+		ArenaAllocator(const ArenaAllocator<U>& other) noexcept : m_arena(other.m_arena) {}
+
+		Arena* GetArena() const { return m_arena; }
+
+		T* allocate(size_t n) {
+			if (m_arena)
+				return static_cast<T*>(m_arena->Allocate(n * sizeof(T), alignof(T)));
+			return std::allocator<T>().allocate(n);
+		}
+
+		void deallocate(T* ptr, size_t n) {
+			if (!m_arena)
+				std::allocator<T>().deallocate(ptr, n);
+		}
+
+		template <class U>
+		bool operator==(const ArenaAllocator<U>& other) const { return m_arena == other.m_arena; }
+		template <class U>
+		bool operator!=(const ArenaAllocator<U>& other) const { return m_arena != other.m_arena; }
+	};
+
+	template <class T>
+	using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+#include <vector>
+#include <cdecl/util.hpp>
+#include "syntax.hpp"
+
+namespace Cdecl {
+	using BatchResult = Result<FunctionProto, string>;
+
+	/*
+	 * Tokenizes and parses many function prototypes at once, one result per declaration in input order.
+	 * Declarations are handed out in chunks of `chunk_size`. Each thread starts on its own share of chunks
+	 * and steals from the others once it runs out, so uneven declarations still keep every thread busy.
+	 *
+	 * threads: 0 uses every hardware thread.
+	 * TypeTable and string pools are shared. With ParseContext::arena, each worker allocates from its own Arena::Child()
+	 * of it, so one Reset() of the arena frees the whole batch. Results must not be used after that.
+	 */
+	std::vector<BatchResult> ParseBatch(
+		const string_view* decls, size_t count, const ParseContext& ctx = ParseContext(), size_t threads = 0, size_t chunk_size = 64
+	);
+
+	inline std::vector<BatchResult> ParseBatch(
+		const std::vector<string_view>& decls, const ParseContext& ctx = ParseContext(), size_t threads = 0, size_t chunk_size = 64
+	) {
+		return ParseBatch(decls.data(), decls.size(), ctx, threads, chunk_size);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <cdecl/util.hpp>
+#include "type.hpp"
+#include "syntax.hpp"
+#include "record.hpp"
+
+namespace Cdecl {
+	/*
+	 * A FunctionProto flattened into register and stack moves for one ABI.
+	 * Callers pack arguments into a buffer at `arg_offsets`, and Invoke() runs `steps` over it before the call,
+	 * so no Type tree is walked per call.
+	 *
+	 * Plans for Win32 conventions can be compiled anywhere, but only x86-64 SysV plans can be invoked, on x86-64 SysV hosts.
+	 */
+	struct CallPlan {
+		enum class Load : uint8_t {
+			I8, U8, I16, U16, I32, U32, I64, F32, F64,
+		};
+
+		enum class Dest : uint8_t {
+			IntReg, // Index into the ABI's integer argument registers, e.g. rdi, rsi... or ecx, edx
+			VecReg, // xmm index
+			Stack, // Slot index from the lowest address. Slots are 8 bytes on x86-64, 4 on x86.
+		};
+
+		struct Step {
+			Load load;
+			Dest dest;
+			uint16_t index;
+			uint32_t src; // Offset in the argument buffer
+		};
+
+		enum class Return : uint8_t {
+			Void,
+			Int, // rax, or eax/edx:eax
+			Float, // xmm0, or st(0)
+		};
+
+		Abi abi;
+		CallConvention conv;
+		std::vector<Step> steps; // One per argument, in order
+		std::vector<uint32_t> arg_offsets;
+		uint32_t args_size; // Bytes in the argument buffer
+		uint32_t stack_slots;
+		uint8_t int_regs_used;
+		uint8_t vec_regs_used;
+		bool callee_cleans;
+		Return ret;
+		Load ret_load;
+		uint32_t ret_size;
+	};
+
+	using CompileCallPlanResult = Result<CallPlan, string>;
+
+	/*
+	 * variadic_args: Types of the arguments passed in place of `...`, for a variadic proto.
+	 * These get the default argument promotions, so a float is packed as a double and a char or short as an int.
+	 * `steps[i].load` is the width argument i is packed with.
+	 * The calling convention comes from the proto, or defaults to cdecl. x86-64 SysV ignores it, like compilers do.
+	 */
+	CompileCallPlanResult CompileCallPlan(
+		const FunctionProto& proto, Abi abi, const std::vector<std::shared_ptr<const Type>>& variadic_args = {}
+	);
+
+	// Whether Invoke() can run this plan on the current host
+	bool CanInvoke(const CallPlan& plan);
+
+	/*
+	 * Calls fn with the arguments packed in `args`, and stores `ret_size` bytes of the result in `ret`.
+	 * Returns false if the plan can't be invoked on this host.
+	 */
+	bool Invoke(const CallPlan& plan, void (*fn)(), const void* args, void* ret);
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+
+namespace Cdecl {
+	class TypeTable;
+	class Arena;
+	class ConcurrentStringPool;
+	class TypedefTable;
+	class TagTable;
+
+	/*
+	 * Optional shared state for a parse.
+	 * Anything left null falls back to the default behavior of allocating fresh nodes on the heap.
+	 *
+	 * Names are stored with the nodes that hold them: in `strings` if set, else in the TypeTable's pool, else in the arena.
+	 * With none of these, each name gets a heap copy of its own, so results never depend on the parsed text.
+	 */
+	struct ParseContext {
+		TypeTable* types = nullptr;
+		Arena* arena = nullptr; // Nodes, their argument and member lists and names go here when there is no TypeTable. They live until the arena resets.
+		ConcurrentStringPool* strings = nullptr;
+		const TypedefTable* typedefs = nullptr; // Identifiers found here are accepted as type names
+		TagTable* tags = nullptr; // Struct and union definitions are added here, and bare tags resolve to them
+		uint32_t pack = 0; // Max member alignment of parsed structs and unions, like #pragma pack(n). 0 is natural alignment.
+	};
+}
\ No newline at end of file
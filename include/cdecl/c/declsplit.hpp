@@ -0,0 +1,171 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <optional>
+#include <cdecl/util.hpp>
+#include <cdecl/scan.hpp>
+
+namespace Cdecl {
+	/*
+	 * Splits C source into top-level declarations at each ';' outside of (), {} and [].
+	 * Slices are zero-copy views of the source, trimmed of whitespace and without the ';'.
+	 * Comments, string/char literals and preprocessor lines never split a declaration.
+	 * Directives and leading comments are left out of slices, but comments inside a declaration stay in it.
+	 */
+	class DeclSplitter {
+		enum CharClass : uint8_t {
+			Plain,
+			Open,
+			Close,
+			Semicolon,
+			Slash,
+			Quote,
+			Hash,
+		};
+
+		static constexpr std::array<uint8_t, 256> MakeClassTable() {
+			std::array<uint8_t, 256> table = {};
+			table['('] = table['{'] = table['['] = Open;
+			table[')'] = table['}'] = table[']'] = Close;
+			table[';'] = Semicolon;
+			table['/'] = Slash;
+			table['"'] = table['\''] = Quote;
+			table['#'] = Hash;
+			return table;
+		}
+
+		static CharClass Classify(char_t ch) {
+			static constexpr std::array<uint8_t, 256> table = MakeClassTable();
+			if (ch < 0 || (size_t)ch >= table.size())
+				return Plain;
+			return (CharClass)table[(size_t)ch];
+		}
+
+		const string_view m_src;
+		size_t m_pos = 0;
+
+		size_t SkipLine(size_t pos) const {
+			while (pos < m_src.length() && m_src[pos] != '\n') {
+				// Line continuation
+				if (m_src[pos] == '\\' && pos + 1 < m_src.length())
+					++pos;
+				++pos;
+			}
+			return pos;
+		}
+
+		size_t SkipBlockComment(size_t pos) const {
+			for (pos += 2; pos + 1 < m_src.length(); ++pos) {
+				if (m_src[pos] == '*' && m_src[pos + 1] == '/')
+					return pos + 2;
+			}
+			return m_src.length();
+		}
+
+		size_t SkipLiteral(size_t pos) const {
+			const char_t quote = m_src[pos];
+			for (++pos; pos < m_src.length(); ++pos) {
+				if (m_src[pos] == '\\')
+					++pos;
+				else if (m_src[pos] == quote || m_src[pos] == '\n')
+					return pos + 1;
+			}
+			return m_src.length();
+		}
+
+		bool AtLineStart(size_t pos) const {
+			while (pos > 0) {
+				char_t ch = m_src[--pos];
+				if (ch == '\n')
+					return true;
+				if (!Scan::IsWhitespace(ch))
+					return false;
+			}
+			return true;
+		}
+
+		string_view Trim(size_t begin, size_t end) const {
+			begin += Scan::Whitespace(m_src.substr(begin, end - begin));
+			while (end > begin && Scan::IsWhitespace(m_src[end - 1]))
+				--end;
+			return m_src.substr(begin, end - begin);
+		}
+
+	public:
+		// pos must be 0 or a position previously returned by Pos()
+		DeclSplitter(const string_view& src, size_t pos = 0) : m_src(src), m_pos(pos) {}
+
+		// Where the next call to Next() resumes. Just past the last ';', or at a directive that ended a declaration.
+		size_t Pos() const { return m_pos; }
+
+		// Returns the next non-empty declaration, or nothing at the end of the source
+		std::optional<string_view> Next() {
+			while (m_pos < m_src.length()) {
+				size_t begin = m_pos;
+				size_t depth = 0;
+				size_t pos = m_pos;
+
+				while (pos < m_src.length()) {
+					switch (Classify(m_src[pos])) {
+					case Plain: ++pos; continue;
+					case Open: ++depth, ++pos; continue;
+					case Close:
+						if (depth)
+							--depth;
+						++pos;
+						continue;
+					case Slash: {
+						bool leading = depth == 0 && Trim(begin, pos).empty();
+						if (pos + 1 < m_src.length() && m_src[pos + 1] == '/')
+							pos = SkipLine(pos);
+						else if (pos + 1 < m_src.length() && m_src[pos + 1] == '*')
+							pos = SkipBlockComment(pos);
+						else {
+							++pos;
+							continue;
+						}
+						// Keep comments out of the front of a slice
+						if (leading)
+							begin = pos;
+						continue;
+					}
+					case Quote: pos = SkipLiteral(pos); continue;
+					case Hash:
+						if (!AtLineStart(pos)) {
+							++pos;
+							continue;
+						}
+						// A directive ends whatever came before it
+						if (depth == 0 && !Trim(begin, pos).empty())
+							break;
+						pos = SkipLine(pos);
+						if (depth == 0)
+							begin = pos;
+						continue;
+					case Semicolon:
+						if (depth) {
+							++pos;
+							continue;
+						}
+						break;
+					}
+					break;
+				}
+
+				string_view decl = Trim(begin, pos);
+				m_pos = pos < m_src.length() && m_src[pos] == ';' ? pos + 1 : pos;
+				if (!decl.empty())
+					return decl;
+			}
+			return {};
+		}
+	};
+
+	inline std::vector<string_view> SplitDeclarations(const string_view& src) {
+		std::vector<string_view> decls;
+		DeclSplitter splitter = DeclSplitter(src);
+		while (std::optional<string_view> decl = splitter.Next())
+			decls.push_back(decl.value());
+		return decls;
+	}
+}
\ No newline at end of file
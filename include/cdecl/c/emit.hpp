@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+#include <cdecl/util.hpp>
+#include "type.hpp"
+#include "syntax.hpp"
+#include "record.hpp"
+
+namespace Cdecl {
+	/*
+	 * Writes types and prototypes back out as C, appending to a caller-owned buffer in one pass with no iostreams.
+	 * Output is canonical: specifiers in a fixed order and `char* const* p` spacing. Call conventions are kept on the
+	 * node they were parsed on, so emitted text parses back into an equal Type or FunctionProto.
+	 *
+	 * Declarators refer to tagged records as `struct Tag`, and only anonymous records get their members inline.
+	 * Emit each definition once with EmitRecord, and parse the output with a TagTable to get the layouts back.
+	 */
+
+	// An abstract declarator, e.g. `const char*`
+	void EmitType(const Type& type, string& out);
+
+	// e.g. `const char* name`. An empty name emits the abstract declarator.
+	void EmitDecl(const Type& type, string_view name, string& out);
+
+	void EmitVariable(const Variable& var, string& out);
+
+	// e.g. `int __stdcall f(const char* s, ...)`, without a trailing ';'
+	void EmitFunctionProto(const FunctionProto& proto, string& out);
+
+	// The definition, `struct Tag { int x; }`, or `struct Tag` if incomplete. #pragma pack is not emitted.
+	void EmitRecord(const Record& record, string& out);
+
+	// Appends each proto followed by `terminator`, reserving space for the whole batch up front
+	void EmitFunctionProtos(const FunctionProto* protos, size_t count, string& out, string_view terminator = ";\n");
+
+	inline void EmitFunctionProtos(const std::vector<FunctionProto>& protos, string& out, string_view terminator = ";\n") {
+		EmitFunctionProtos(protos.data(), protos.size(), out, terminator);
+	}
+}
\ No newline at end of file
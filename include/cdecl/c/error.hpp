@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <cdecl/util.hpp>
+#include <cdecl/tokenbuffer.hpp>
+#include <cdecl/parsestats.hpp>
+#include "tokendefs.hpp"
+
+namespace Cdecl {
+	enum class ErrorCode : uint8_t {
+		UnhandledToken,
+		InvalidLong,
+		LongAndShort,
+		MultipleCallConventions,
+		InvalidSpecifiers,
+		IntSpecifiersOnNonInt,
+		IntSpecifiersOnPointer,
+		ExpectedPrimitive,
+		ExpectedIdentifier,
+		ExpectedArguments,
+		ExpectedTypedef,
+		TypedefRedefinition,
+		ExpectedRecordBody,
+		ExpectedSemicolon,
+		TagRedefinition,
+		TrailingTokens,
+	};
+
+	const char* GetErrorMessage(ErrorCode code);
+
+	/*
+	 * Parse failure that costs nothing to build or throw away.
+	 * Call Render() to get a human-readable message, only when one is actually needed.
+	 */
+	struct ParseError {
+		ErrorCode code;
+		uint32_t pos; // Token index
+		uint32_t detail; // Code-specific, e.g. the token id for UnhandledToken
+		TokenSet expected;
+
+		ParseError(ErrorCode code_, size_t pos_, uint32_t detail_ = 0, TokenSet expected_ = TokenSet())
+			: code(code_), pos((uint32_t)pos_), detail(detail_), expected(expected_) {
+			Stats::Count(&ParseStats::errors);
+		}
+
+		string Render(const TokenBuffer& tokens) const;
+	};
+}
\ No newline at end of file
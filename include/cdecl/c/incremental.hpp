@@ -0,0 +1,55 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <cdecl/util.hpp>
+#include <cdecl/tokenbuffer.hpp>
+#include "syntax.hpp"
+
+namespace Cdecl {
+	/*
+	 * Keeps a buffer of prototypes parsed while it is being edited.
+	 * Each declaration keeps its source range, tokens and parse result. An edit re-splits the buffer from the
+	 * declaration before the damage, re-lexes and re-parses only what changed, and stops as soon as it lines up with an
+	 * old declaration boundary again. Everything past that point is reused, with only its offsets shifted.
+	 *
+	 * Results of reused declarations are the same shared_ptrs as before the edit. Each declaration parses into a small
+	 * arena of its own that its result keeps alive, so a replaced declaration's nodes and names are freed as soon as no
+	 * caller holds its result. Types reached through a result are only valid while the result is held.
+	 * ParseContext::arena is not used. Other context members must outlive the parser.
+	 */
+	class IncrementalParser {
+	public:
+		using DeclResult = Result<std::shared_ptr<const FunctionProto>, string>;
+
+		struct Decl {
+			size_t begin; // Trimmed declaration text, without the ';'
+			size_t length;
+			size_t end; // Where the next declaration's search starts
+			TokenBuffer tokens; // Views into Text(). Empty if lexing failed.
+			DeclResult result;
+		};
+
+		// Index range of declarations replaced by an edit. Decls at or after `first + inserted` were reused.
+		struct EditResult {
+			size_t first;
+			size_t removed;
+			size_t inserted;
+		};
+
+	private:
+		string m_text;
+		ParseContext m_ctx;
+		std::vector<Decl> m_decls;
+
+		Decl MakeDecl(const string_view& decl, size_t end) const;
+
+	public:
+		IncrementalParser(string text = string(), const ParseContext& ctx = ParseContext());
+
+		// Replaces `removed` chars at `offset` with `inserted`. Out-of-range edits are clamped to the text.
+		EditResult Edit(size_t offset, size_t removed, const string_view& inserted);
+
+		const string& Text() const { return m_text; }
+		const std::vector<Decl>& GetDecls() const { return m_decls; }
+	};
+}
\ No newline at end of file
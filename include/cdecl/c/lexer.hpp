@@ -0,0 +1,148 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cdecl/tokenizer.hpp>
+#include <cdecl/scan.hpp>
+#include "tokendefs.hpp"
+
+namespace Cdecl {
+	namespace LexerTables {
+		constexpr size_t keyword_slots = 64;
+		constexpr uint8_t empty_slot = UINT8_MAX;
+		constexpr size_t keyword_count = sizeof(keyword_spellings) / sizeof(keyword_spellings[0]);
+		constexpr size_t punctuator_count = sizeof(punctuator_spellings) / sizeof(punctuator_spellings[0]);
+
+		template <class TChar>
+		constexpr uint32_t Hash(const TChar* str, size_t length, uint32_t seed) {
+			uint32_t h = seed;
+			for (size_t i = 0; i < length; ++i)
+				h = h * 31 + (uint32_t)str[i];
+			h ^= h >> 15;
+			h *= 0x2c1b3c6d;
+			h ^= h >> 12;
+			return h % keyword_slots;
+		}
+
+		constexpr bool IsPerfectSeed(uint32_t seed) {
+			bool used[keyword_slots] = {};
+			for (const TokenSpelling& kw : keyword_spellings) {
+				uint32_t slot = Hash(kw.str.data(), kw.str.length(), seed);
+				if (used[slot])
+					return false;
+				used[slot] = true;
+			}
+			return true;
+		}
+
+		constexpr uint32_t FindSeed() {
+			for (uint32_t seed = 1; seed < (1 << 16); ++seed) {
+				if (IsPerfectSeed(seed))
+					return seed;
+			}
+			return 0;
+		}
+
+		constexpr bool IsIdentifierShaped(std::string_view str) {
+			if (str.empty() || (str[0] >= '0' && str[0] <= '9'))
+				return false;
+			for (char ch : str) {
+				bool ident = ch == '_' || (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9');
+				if (!ident)
+					return false;
+			}
+			return true;
+		}
+
+		constexpr bool ValidateTable() {
+			for (const TokenSpelling& kw : keyword_spellings) {
+				if (!IsIdentifierShaped(kw.str))
+					return false;
+			}
+			for (const TokenSpelling& punct : punctuator_spellings) {
+				if (punct.str.length() != 1 || (unsigned char)punct.str[0] >= 128)
+					return false;
+			}
+			return keyword_count < empty_slot && punctuator_count < empty_slot;
+		}
+
+		constexpr uint32_t seed = FindSeed();
+
+		constexpr std::array<uint8_t, keyword_slots> MakeKeywordTable() {
+			std::array<uint8_t, keyword_slots> table = {};
+			for (uint8_t& slot : table)
+				slot = empty_slot;
+			for (size_t i = 0; i < keyword_count; ++i)
+				table[Hash(keyword_spellings[i].str.data(), keyword_spellings[i].str.length(), seed)] = (uint8_t)i;
+			return table;
+		}
+
+		constexpr std::array<uint8_t, 128> MakePunctuatorTable() {
+			std::array<uint8_t, 128> table = {};
+			for (uint8_t& slot : table)
+				slot = empty_slot;
+			for (size_t i = 0; i < punctuator_count; ++i)
+				table[(size_t)punctuator_spellings[i].str[0]] = (uint8_t)i;
+			return table;
+		}
+
+		static_assert(ValidateTable(), "Keywords must be identifier-shaped and punctuators must be single ASCII chars");
+		static_assert(seed != 0, "No perfect hash seed found for keyword_spellings");
+
+		constexpr std::array<uint8_t, keyword_slots> keyword_table = MakeKeywordTable();
+		constexpr std::array<uint8_t, 128> punctuator_table = MakePunctuatorTable();
+	}
+
+	/*
+	 * Lexer for the built-in C token table, generated entirely at compile time.
+	 * Produces the same tokens as `tokenizer`, without static initialization or dispatch through TokenDef.
+	 * Keywords are found through a perfect hash over keyword_spellings, and punctuators through a char table.
+	 */
+	class Lexer {
+		static tokenid_t KeywordOrIdentifier(const char_t* str, size_t length) {
+			uint8_t index = LexerTables::keyword_table[LexerTables::Hash(str, length, LexerTables::seed)];
+			if (index == LexerTables::empty_slot)
+				return TokenId::Identifier;
+
+			const std::string_view& kw = keyword_spellings[index].str;
+			if (kw.length() != length)
+				return TokenId::Identifier;
+			for (size_t i = 0; i < length; ++i) {
+				if ((char_t)kw[i] != str[i])
+					return TokenId::Identifier;
+			}
+			return keyword_spellings[index].id;
+		}
+
+	public:
+		using ParseResult = Tokenizer::ParseResult;
+
+		static std::optional<Token> ParseAt(StringCursor cursor) {
+			const char_t* begin = cursor.Peek();
+			if (!begin)
+				return {};
+
+			const char_t ch = *begin;
+			if (Scan::IsIdentifierStart(ch)) {
+				size_t length = Scan::IdentifierChars(cursor.Remaining());
+				return Token(KeywordOrIdentifier(begin, length), string_view(begin, length));
+			}
+
+			if (ch >= 0 && (size_t)ch < LexerTables::punctuator_table.size()) {
+				uint8_t index = LexerTables::punctuator_table[(size_t)ch];
+				if (index != LexerTables::empty_slot)
+					return Token(punctuator_spellings[index].id, string_view(begin, 1));
+			}
+
+			return {};
+		}
+
+		static ParseResult ParseAll(const string_view& str) {
+			return TokenizeAll(str, ParseAt);
+		}
+
+		using ParseBufferResult = Tokenizer::ParseBufferResult;
+		static ParseBufferResult ParseBuffer(const string_view& str, TokenBuffer&& reuse = TokenBuffer()) {
+			return TokenizeBuffer(str, ParseAt, std::move(reuse));
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <memory>
+#include <variant>
+#include <unordered_map>
+#include <cdecl/util.hpp>
+#include <cdecl/tokenbuffer.hpp>
+#include <cdecl/stringpool.hpp>
+#include "type.hpp"
+#include "syntax.hpp"
+
+namespace Cdecl {
+	/*
+	 * Bounded LRU cache in front of Type::Parse and FunctionProto::Parse, safe to use from many threads at once.
+	 * Text is keyed by its token sequence and the parts of the context that change results, so "int*  x" and "int *x"
+	 * share an entry but a parse under one TypeTable, set of typedefs or tags, or packing is never returned to a caller
+	 * using another.
+	 * Results are immutable and shared between every caller that hits the same entry. The whole text must parse, so leftover tokens are an error. Failed parses are not cached.
+	 *
+	 * Cached nodes must outlive any arena, so ParseContext::arena is ignored. Names go to ParseContext::strings or the
+	 * TypeTable's pool if either is set, and otherwise to the cache's own pool. Other context members must outlive the cache.
+	 */
+	class ParseCache {
+	public:
+		struct Stats {
+			uint64_t hits;
+			uint64_t misses;
+			uint64_t evictions;
+		};
+
+		using TypeResult = Result<std::shared_ptr<const Type>, string>;
+		using ProtoResult = Result<std::shared_ptr<const FunctionProto>, string>;
+
+	private:
+		static constexpr size_t shard_count = 16;
+
+		using Value = std::variant<std::shared_ptr<const Type>, std::shared_ptr<const FunctionProto>>;
+
+		struct Entry {
+			string key;
+			Value value;
+		};
+
+		struct Shard {
+			std::mutex mutex;
+			std::list<Entry> lru; // Most recently used first
+			std::unordered_map<string_view, std::list<Entry>::iterator> index; // Keys view into Entry::key
+		};
+
+		std::array<Shard, shard_count> m_shards;
+		size_t m_shard_capacity;
+		std::atomic<uint64_t> m_hits = 0;
+		std::atomic<uint64_t> m_misses = 0;
+		std::atomic<uint64_t> m_evictions = 0;
+		ConcurrentStringPool m_strings;
+
+		Shard& GetShard(const string& key) { return m_shards[std::hash<string>()(key) % shard_count]; }
+
+		ParseContext MakeHeapContext(const ParseContext& ctx);
+		std::optional<Value> Find(const string& key);
+		Value Insert(string&& key, Value&& value);
+
+	public:
+		// capacity: Max entries kept across all shards
+		ParseCache(size_t capacity = 4096) : m_shard_capacity(std::max<size_t>(1, capacity / shard_count)) {}
+		ParseCache(const ParseCache&) = delete;
+		ParseCache& operator=(const ParseCache&) = delete;
+
+		TypeResult ParseType(const string_view& text, TypeParseMask mask, const ParseContext& ctx = ParseContext());
+		ProtoResult ParseFunctionProto(const string_view& text, const ParseContext& ctx = ParseContext());
+
+		Stats GetStats() const { return Stats{ m_hits.load(), m_misses.load(), m_evictions.load() }; }
+		size_t Size();
+		void Clear();
+	};
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <cdecl/util.hpp>
+#include "type.hpp"
+#include "syntax.hpp"
+
+namespace Cdecl {
+	enum class Abi {
+		SysV_x64,
+		Win64,
+		Win32,
+	};
+
+	struct TypeLayout {
+		uint64_t size;
+		uint64_t align;
+	};
+
+	struct RecordLayout {
+		uint64_t size;
+		uint64_t align;
+		std::vector<uint64_t> offsets; // One per member, in declaration order
+	};
+
+	// Returns nothing for types without a size: void, bare functions, and incomplete structs
+	std::optional<TypeLayout> GetTypeLayout(const Type& type, Abi abi);
+
+	/*
+	 * A struct or union, with its members indexed by name.
+	 * Layouts are computed the first time each ABI is asked for, then cached, so later queries are O(1).
+	 */
+	class Record {
+		static constexpr size_t abi_count = 3;
+
+		const Name m_tag; // Empty if anonymous
+		const bool m_union;
+		const bool m_complete;
+		const uint32_t m_pack;
+		using Index = std::unordered_map<string_view, size_t, std::hash<string_view>, std::equal_to<string_view>, ArenaAllocator<std::pair<const string_view, size_t>>>;
+
+		const ArenaVector<Variable> m_members;
+		Index m_index; // Allocated alongside m_members
+		size_t m_hash;
+
+		mutable std::once_flag m_layout_once[abi_count];
+		mutable std::optional<RecordLayout> m_layouts[abi_count];
+
+	public:
+		// An incomplete record, e.g. `struct Foo` without a member list
+		Record(Name tag, bool is_union);
+
+		// pack: Max member alignment, like #pragma pack(n). 0 is natural alignment.
+		Record(Name tag, bool is_union, ArenaVector<Variable>&& members, uint32_t pack = 0);
+
+		Record(const Record&) = delete;
+		Record& operator=(const Record&) = delete;
+
+		string_view GetTag() const { return m_tag; }
+		bool IsUnion() const { return m_union; }
+		bool IsComplete() const { return m_complete; }
+		uint32_t GetPack() const { return m_pack; }
+		const ArenaVector<Variable>& GetMembers() const { return m_members; }
+
+		size_t Hash() const { return m_hash; }
+		bool operator==(const Record& other) const;
+		bool operator!=(const Record& other) const { return !(*this == other); }
+
+		std::optional<size_t> FindMember(const string_view& name) const {
+			auto it = m_index.find(name);
+			if (it == m_index.end())
+				return {};
+			return it->second;
+		}
+
+		// Returns nullptr if the record or one of its members has no size
+		const RecordLayout* GetLayout(Abi abi) const;
+
+		std::optional<uint64_t> GetOffset(const string_view& member, Abi abi) const {
+			std::optional<size_t> index = FindMember(member);
+			const RecordLayout* layout = GetLayout(abi);
+			if (!index.has_value() || !layout)
+				return {};
+			return layout->offsets[index.value()];
+		}
+	};
+}
\ No newline at end of file
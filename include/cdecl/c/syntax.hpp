@@ -1,65 +1,104 @@
-#include "tokendefs.hpp"
-#include "type.hpp"
-#include <cdecl/tokencursor.hpp>
-#include <variant>
-#include <sstream>
-
-namespace Cdecl {
-	class Variable {
-		const std::shared_ptr<const Type> m_type;
-		const string m_name;
-
-	public:
-		Variable(const std::shared_ptr<const Type>& type, string&& name) : m_type(type), m_name(name) {}
-
-		const std::shared_ptr<const Type>& GetType() const { return m_type; }
-		const string& GetName() const { return m_name; }
-
-		using ParseResult = Result<std::pair<Variable, TokenCursor>, string>;
-		static ParseResult Parse(TokenCursor cur, TypeParseMask mask);
-	};
-
-	class Argument {
-		using type_type = std::shared_ptr<const Type>;
-		using base_type = std::optional<std::variant<type_type, Variable>>;
-
-		const base_type m_base;
-
-	public:
-		Argument() : m_base() {}
-		Argument(const std::shared_ptr<const Type>& type) : m_base(type) {}
-		Argument(Variable&& var) : m_base(var) {}
-
-		bool IsType() const { return !IsVariadic() && std::holds_alternative<type_type>(m_base.value()); }
-		bool IsVariable() const { return !IsVariadic() && std::holds_alternative<Variable>(m_base.value()); }
-		bool IsVariadic() const { return !m_base.has_value(); }
-
-		const std::shared_ptr<const Type>& GetType() const { return std::get<type_type>(m_base.value()); }
-		const Variable& GetVar() const { return std::get<Variable>(m_base.value()); }
-
-		using ParseResult = Result<std::pair<Argument, TokenCursor>, string>;
-		static ParseResult Parse(TokenCursor cur);
-	};
-
-	class FunctionProto {
-		const std::shared_ptr<const Type> m_ret_type;
-		const std::vector<Argument> m_args;
-
-	public:
-		FunctionProto(string name, std::shared_ptr<const Type>& ret_type, std::vector<Argument>& args, CallConvention conv = CallConvention::Cdecl)
-			: m_ret_type(ret_type) {}
-
-		bool HasDecl() const { return m_ret_type->HasDecl(); }
-
-		const std::shared_ptr<const Type> GetReturnType() const { return m_ret_type; }
-		const std::vector<Argument>& GetArgs() const { return m_args; }
-		const string& GetDecl() const { return m_ret_type->GetDecl(); }
-
-		CallConvention GetConventionOrDefault(CallConvention default_) const {
-			return m_ret_type->HasCallConvention() ? m_ret_type->GetConvention() : default_;
-		}
-
-		using ParseResult = Result<std::pair<FunctionProto, StringCursor>, string>;
-		static ParseResult Parse(TokenCursor cur);
-	};
+#pragma once
+#include "tokendefs.hpp"
+#include "type.hpp"
+#include <cdecl/tokencursor.hpp>
+#include <cdecl/arena.hpp>
+#include <variant>
+#include <sstream>
+
+namespace Cdecl {
+	/*
+	 * A declarator or tag name. Usually a view into storage the ParseContext provides, like a StringPool or an arena.
+	 * A parse with nowhere to store names gives each one its own heap copy instead, so names never view the parsed text.
+	 */
+	class Name {
+		std::shared_ptr<const string> m_owned;
+		string_view m_view;
+
+	public:
+		Name() = default;
+
+		// view must outlive the Name, e.g. a view from a StringPool
+		Name(string_view view) : m_view(view) {}
+
+		explicit Name(std::shared_ptr<const string> owned) : m_owned(std::move(owned)), m_view(*m_owned) {}
+
+		operator string_view() const { return m_view; }
+	};
+
+	class Variable {
+		const std::shared_ptr<const Type> m_type;
+		const Name m_name;
+
+	public:
+		Variable(const std::shared_ptr<const Type>& type, Name name) : m_type(type), m_name(std::move(name)) {}
+
+		const std::shared_ptr<const Type>& GetType() const { return m_type; }
+		string_view GetName() const { return m_name; }
+
+		using ParseResult = Result<std::pair<Variable, TokenCursor>, ParseError>;
+		static ParseResult Parse(TokenCursor cur, TypeParseMask mask, const ParseContext& ctx = ParseContext());
+	};
+
+	class Argument {
+		using type_type = std::shared_ptr<const Type>;
+		using base_type = std::optional<std::variant<type_type, Variable>>;
+
+		const base_type m_base;
+
+	public:
+		Argument() : m_base() {}
+		Argument(const std::shared_ptr<const Type>& type) : m_base(type) {}
+		Argument(Variable&& var) : m_base(var) {}
+
+		bool IsType() const { return !IsVariadic() && std::holds_alternative<type_type>(m_base.value()); }
+		bool IsVariable() const { return !IsVariadic() && std::holds_alternative<Variable>(m_base.value()); }
+		bool IsVariadic() const { return !m_base.has_value(); }
+
+		const std::shared_ptr<const Type>& GetType() const { return std::get<type_type>(m_base.value()); }
+		const Variable& GetVar() const { return std::get<Variable>(m_base.value()); }
+
+		using ParseResult = Result<std::pair<Argument, TokenCursor>, ParseError>;
+		static ParseResult Parse(TokenCursor cur, const ParseContext& ctx = ParseContext());
+	};
+
+	class FunctionProto {
+		const Name m_name;
+		const std::shared_ptr<const Type> m_ret_type;
+		const ArenaVector<Argument> m_args;
+		const size_t m_hash;
+
+		static size_t ComputeHash(string_view name, const Type& ret_type, const ArenaVector<Argument>& args);
+
+	public:
+		FunctionProto(Name name, std::shared_ptr<const Type>& ret_type, ArenaVector<Argument>& args, CallConvention conv = CallConvention::Cdecl)
+			: m_name(std::move(name)), m_ret_type(ret_type), m_args(args), m_hash(ComputeHash(m_name, *ret_type, args)) {}
+
+		string_view GetName() const { return m_name; }
+
+		// Covers the name, return type and every argument's type and name
+		size_t Hash() const { return m_hash; }
+		bool operator==(const FunctionProto& other) const;
+		bool operator!=(const FunctionProto& other) const { return !(*this == other); }
+
+		bool HasDecl() const { return m_ret_type->HasDecl(); }
+
+		const std::shared_ptr<const Type> GetReturnType() const { return m_ret_type; }
+		const ArenaVector<Argument>& GetArgs() const { return m_args; }
+		string_view GetDecl() const { return m_ret_type->GetDecl(); }
+
+		CallConvention GetConventionOrDefault(CallConvention default_) const {
+			return m_ret_type->HasCallConvention() ? m_ret_type->GetConvention() : default_;
+		}
+
+		using ParseResult = Result<std::pair<FunctionProto, TokenCursor>, ParseError>;
+		static ParseResult Parse(TokenCursor cur, const ParseContext& ctx = ParseContext());
+	};
+}
+
+namespace std {
+	template <>
+	struct hash<Cdecl::FunctionProto> {
+		size_t operator()(const Cdecl::FunctionProto& proto) const { return proto.Hash(); }
+	};
 }
\ No newline at end of file
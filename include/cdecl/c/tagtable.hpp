@@ -0,0 +1,36 @@
+#pragma once
+#include <memory>
+#include <cdecl/util.hpp>
+#include "typedeftable.hpp"
+#include "typetable.hpp"
+#include "record.hpp"
+
+namespace Cdecl {
+	/*
+	 * Struct and union tag scope for ParseContext::tags, kept apart from typedef names as in C.
+	 * A member list parsed with a TagTable defines its tag, and later bare `struct Tag` references resolve to that
+	 * Record instead of a new incomplete one. References parsed before the definition stay incomplete.
+	 *
+	 * Built on TypedefTable, so Find() never locks. Definitions are parsed into the table's own TypeTable when the
+	 * context has none, so they outlive any arena.
+	 */
+	class TagTable {
+		TypedefTable m_records; // Each tag names a Type wrapping its Record
+		TypeTable m_types;
+
+	public:
+		TagTable(size_t capacity = 256) : m_records(capacity) {}
+		TagTable(const TagTable&) = delete;
+		TagTable& operator=(const TagTable&) = delete;
+
+		// Returns false if the record's tag already names a different definition
+		bool Define(const std::shared_ptr<const Record>& record);
+
+		// Returns nullptr if tag isn't defined
+		std::shared_ptr<const Record> Find(const string_view& tag) const;
+
+		size_t Size() const { return m_records.Size(); }
+
+		TypeTable& GetTypes() { return m_types; }
+	};
+}
\ No newline at end of file
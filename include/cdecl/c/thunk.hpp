@@ -0,0 +1,68 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <cdecl/util.hpp>
+#include "callplan.hpp"
+
+namespace Cdecl {
+	/*
+	 * Hands out native function pointers that call a std::function, for any prototype a CallPlan supports.
+	 * Each thunk is a 16-byte stub in a pooled executable page. The stub loads its context from a data page next to it
+	 * and jumps to a shared trampoline, which spills the argument registers and calls the dispatcher.
+	 * Code pages are written once when they are mapped and are never writable afterwards.
+	 *
+	 * Thunks sharing a prototype share one CallPlan. Freed slots are reused, and every page is released with the allocator.
+	 * x86-64 SysV hosts only. Callbacks must not throw, since the stubs have no unwind info.
+	 */
+	class ThunkAllocator {
+	public:
+		using Thunk = void (*)();
+
+		// args is packed like CallPlan::arg_offsets. Write the return value, if any, to ret.
+		using Callback = std::function<void(const void* args, void* ret)>;
+
+		using CreateResult = Result<Thunk, string>;
+
+	private:
+		struct Context {
+			std::shared_ptr<const CallPlan> plan;
+			Callback callback;
+		};
+
+		struct Page {
+			unsigned char* code; // Trampoline followed by the stubs. Executable.
+			Context** contexts; // One per stub, read by the stubs. Writable, right after the code.
+			std::vector<std::unique_ptr<Context>> owned;
+		};
+
+		std::mutex m_mutex;
+		std::vector<Page> m_pages;
+		std::vector<Thunk> m_free;
+		std::unordered_map<string, std::shared_ptr<const CallPlan>> m_plans; // Keyed by the plan's moves
+		size_t m_live = 0;
+
+		// Called by the trampoline with the stub's context, the spilled argument registers and the caller's stack arguments
+		static uint64_t Dispatch(const Context* ctx, void* frame, const uint64_t* stack);
+
+		std::optional<string> MapPage();
+		std::shared_ptr<const CallPlan> GetPlan(CallPlan&& plan);
+
+	public:
+		ThunkAllocator() = default;
+		ThunkAllocator(const ThunkAllocator&) = delete;
+		ThunkAllocator& operator=(const ThunkAllocator&) = delete;
+
+		// Frees every thunk at once. None may be running.
+		~ThunkAllocator();
+
+		CreateResult Create(const FunctionProto& proto, Callback callback);
+
+		// The thunk must not be running. Its slot is reused by a later Create().
+		void Free(Thunk thunk);
+
+		size_t Size();
+	};
+}
\ No newline at end of file
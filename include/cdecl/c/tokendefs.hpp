@@ -1,113 +1,167 @@
-#pragma once
-#include <cdecl/tokenizer.hpp>
-#include <cdecl/util.hpp>
-#include <vector>
-
-namespace Cdecl {
-	namespace TokenId {
-		enum TokenId : tokenid_t {
-			Cdecl,
-			Stdcall,
-			Fastcall,
-			Thiscall,
-			Vectorcall,
-
-			Const,
-			Volatile,
-			Char,
-			Enum,
-			Extern,
-			Static,
-			Float,
-			Double,
-			Int,
-			Long,
-			Short,
-			Unsigned,
-			Signed,
-			Struct,
-			Union,
-			Void,
-
-			Int8_t,
-			Int16_t,
-			Int32_t,
-			Int64_t,
-			Uint8_t,
-			Uint16_t,
-			Uint32_t,
-			Uint64_t,
-
-			Curly_Open,
-			Curly_Close,
-			Square_Open,
-			Square_Close,
-			Round_Open,
-			Round_Close,
-			Comma,
-			Asterisk,
-			Period,
-
-			Identifier,
-		};
-	}
-
-	inline std::optional<Token> rule_identifier(StringCursor cur) {
-		const char_t* begin = cur.Peek();
-		if (!begin)
-			return {};
-
-		const char_t* next = begin;
-		while (*next == '_' || std::isalpha(*next)) {
-			++next;
-			if (!cur.Skip())
-				break;
-		}
-
-		if (!begin || next == begin)
-			return {};
-		return Token(TokenId::Identifier, string_view(begin, next - begin));
-	}
-
-	const Tokenizer tokenizer = Tokenizer({
-		TokenDef::Static(TokenId::Cdecl, "__cdecl", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Stdcall, "__stdcall", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Fastcall, "__fastcall", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Thiscall, "__thiscall", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Vectorcall, "__vectorcall", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Const, "const", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Volatile, "volatile", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Char, "char", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Enum, "enum", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Extern, "extern", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Static, "static", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Float, "float", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Double, "double", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Int, "int", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Long, "long", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Short, "short", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Unsigned, "unsigned", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Signed, "signed", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Struct, "struct", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Union, "union", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Void, "void", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Int8_t, "int8_t", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Int16_t, "int16_t", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Int32_t, "int32_t", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Int64_t, "int64_t", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Uint8_t, "uint8_t", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Uint16_t, "uint16_t", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Uint32_t, "uint32_t", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Uint64_t, "uint64_t", TokenDef::Static::Keyword),
-		TokenDef::Static(TokenId::Curly_Open, "{"),
-		TokenDef::Static(TokenId::Curly_Close, "}"),
-		TokenDef::Static(TokenId::Square_Open, "["),
-		TokenDef::Static(TokenId::Square_Close, "]"),
-		TokenDef::Static(TokenId::Round_Open, "("),
-		TokenDef::Static(TokenId::Round_Close, ")"),
-		TokenDef::Static(TokenId::Comma, ","),
-		TokenDef::Static(TokenId::Asterisk, "*"),
-		TokenDef::Static(TokenId::Period, "."),
-		TokenDef::Dynamic(rule_identifier),
-	});
+#pragma once
+#include <cdecl/tokenizer.hpp>
+#include <cdecl/util.hpp>
+#include <vector>
+#include <string_view>
+
+namespace Cdecl {
+	namespace TokenId {
+		enum TokenId : tokenid_t {
+			Cdecl,
+			Stdcall,
+			Fastcall,
+			Thiscall,
+			Vectorcall,
+
+			Const,
+			Volatile,
+			Char,
+			Enum,
+			Extern,
+			Static,
+			Typedef,
+			Float,
+			Double,
+			Int,
+			Long,
+			Short,
+			Unsigned,
+			Signed,
+			Struct,
+			Union,
+			Void,
+
+			Int8_t,
+			Int16_t,
+			Int32_t,
+			Int64_t,
+			Uint8_t,
+			Uint16_t,
+			Uint32_t,
+			Uint64_t,
+
+			Curly_Open,
+			Curly_Close,
+			Square_Open,
+			Square_Close,
+			Round_Open,
+			Round_Close,
+			Comma,
+			Asterisk,
+			Period,
+			Semicolon,
+
+			Identifier,
+		};
+	}
+
+	/*
+	 * Set of C token ids, one bit per id
+	 */
+	struct TokenSet {
+		uint64_t bits;
+
+		template <class ...TIds>
+		constexpr TokenSet(TIds... ids) : bits((0ull | ... | (1ull << (tokenid_t)ids))) {}
+
+		constexpr bool Contains(tokenid_t id) const { return id < 64 && (bits >> id) & 1; }
+		constexpr bool Empty() const { return bits == 0; }
+		constexpr TokenSet operator|(TokenSet other) const { TokenSet set; set.bits = bits | other.bits; return set; }
+	};
+
+	static_assert(TokenId::Identifier < 64, "TokenSet only holds 64 ids");
+
+	// Token classes for TokenCursor::MatchClass and PeekClass
+	namespace TokenClass {
+		constexpr TokenSet Qualifier = TokenSet(TokenId::Const, TokenId::Volatile);
+		constexpr TokenSet IntModifier = TokenSet(TokenId::Signed, TokenId::Unsigned, TokenId::Short, TokenId::Long);
+		constexpr TokenSet CallConv = TokenSet(
+			TokenId::Cdecl, TokenId::Stdcall, TokenId::Fastcall, TokenId::Thiscall, TokenId::Vectorcall
+		);
+		constexpr TokenSet Primitive = TokenSet(
+			TokenId::Int8_t, TokenId::Int16_t, TokenId::Int32_t, TokenId::Int64_t,
+			TokenId::Uint8_t, TokenId::Uint16_t, TokenId::Uint32_t, TokenId::Uint64_t,
+			TokenId::Char, TokenId::Int, TokenId::Float, TokenId::Double, TokenId::Void
+		);
+
+		// Everything that may surround a primitive or follow a '*'
+		constexpr TokenSet TypeSpecifier = Qualifier | IntModifier | CallConv;
+		constexpr TokenSet DeclSpecifier = TypeSpecifier | Primitive;
+	}
+
+	inline std::optional<Token> rule_identifier(StringCursor cur) {
+		const char_t* begin = cur.Peek();
+		if (!begin || !Scan::IsIdentifierStart(*begin))
+			return {};
+
+		size_t length = Scan::IdentifierChars(cur.Remaining());
+		return Token(TokenId::Identifier, string_view(begin, length));
+	}
+
+	/*
+	 * The built-in C token table.
+	 * Both the runtime `tokenizer` and the compile-time lexer in lexer.hpp are generated from these.
+	 */
+	struct TokenSpelling {
+		tokenid_t id;
+		std::string_view str;
+	};
+
+	constexpr TokenSpelling keyword_spellings[] = {
+		{ TokenId::Cdecl, "__cdecl" },
+		{ TokenId::Stdcall, "__stdcall" },
+		{ TokenId::Fastcall, "__fastcall" },
+		{ TokenId::Thiscall, "__thiscall" },
+		{ TokenId::Vectorcall, "__vectorcall" },
+		{ TokenId::Const, "const" },
+		{ TokenId::Volatile, "volatile" },
+		{ TokenId::Char, "char" },
+		{ TokenId::Enum, "enum" },
+		{ TokenId::Extern, "extern" },
+		{ TokenId::Static, "static" },
+		{ TokenId::Typedef, "typedef" },
+		{ TokenId::Float, "float" },
+		{ TokenId::Double, "double" },
+		{ TokenId::Int, "int" },
+		{ TokenId::Long, "long" },
+		{ TokenId::Short, "short" },
+		{ TokenId::Unsigned, "unsigned" },
+		{ TokenId::Signed, "signed" },
+		{ TokenId::Struct, "struct" },
+		{ TokenId::Union, "union" },
+		{ TokenId::Void, "void" },
+		{ TokenId::Int8_t, "int8_t" },
+		{ TokenId::Int16_t, "int16_t" },
+		{ TokenId::Int32_t, "int32_t" },
+		{ TokenId::Int64_t, "int64_t" },
+		{ TokenId::Uint8_t, "uint8_t" },
+		{ TokenId::Uint16_t, "uint16_t" },
+		{ TokenId::Uint32_t, "uint32_t" },
+		{ TokenId::Uint64_t, "uint64_t" },
+	};
+
+	constexpr TokenSpelling punctuator_spellings[] = {
+		{ TokenId::Curly_Open, "{" },
+		{ TokenId::Curly_Close, "}" },
+		{ TokenId::Square_Open, "[" },
+		{ TokenId::Square_Close, "]" },
+		{ TokenId::Round_Open, "(" },
+		{ TokenId::Round_Close, ")" },
+		{ TokenId::Comma, "," },
+		{ TokenId::Asterisk, "*" },
+		{ TokenId::Period, "." },
+		{ TokenId::Semicolon, ";" },
+	};
+
+	inline std::vector<TokenDef> MakeTokenDefs() {
+		std::vector<TokenDef> defs;
+		for (const TokenSpelling& kw : keyword_spellings)
+			defs.emplace_back(TokenDef::Static(kw.id, std::basic_string<char_t>(kw.str.begin(), kw.str.end()), TokenDef::Static::Keyword));
+		for (const TokenSpelling& punct : punctuator_spellings)
+			defs.emplace_back(TokenDef::Static(punct.id, std::basic_string<char_t>(punct.str.begin(), punct.str.end())));
+		defs.emplace_back(TokenDef::Dynamic(rule_identifier));
+		return defs;
+	}
+
+	const Tokenizer tokenizer = Tokenizer(MakeTokenDefs());
 }
\ No newline at end of file
@@ -0,0 +1,291 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <cdecl/util.hpp>
+#include <cdecl/mappedfile.hpp>
+#include "type.hpp"
+#include "syntax.hpp"
+#include "record.hpp"
+
+namespace Cdecl {
+	/*
+	 * On-disk layout of a type database. Everything is little-endian and 4-byte aligned,
+	 * and every reference is an offset from the field holding it, so a mapped file is used in place with no fixups.
+	 * Nodes are read in place, so the format is only supported on little-endian hosts.
+	 */
+	namespace TypeDbFormat {
+		static constexpr char magic[8] = { 'C', 'D', 'E', 'C', 'L', 'T', 'D', 'B' };
+		static constexpr uint32_t version = 2;
+
+		// Self-relative reference. 0 is null, since no field refers to itself.
+		struct Ref {
+			int32_t rel;
+		};
+
+		struct String {
+			Ref data;
+			uint32_t length; // In char_t units
+		};
+
+		enum class TypeKind : uint8_t {
+			Primitive,
+			Pointee,
+			Proto,
+			Record,
+		};
+
+		enum class ArgKind : uint8_t {
+			Type,
+			Variable,
+			Variadic,
+		};
+
+		// Same bits as Type's flags
+		enum TypeFlags : uint32_t {
+			Pointer = 1 << 0,
+			Volatile = 1 << 1,
+			Const = 1 << 2,
+			Signed = 1 << 3,
+			Unsigned = 1 << 4,
+			Long = 1 << 5,
+			LongLong = 1 << 6,
+			Short = 1 << 7,
+		};
+
+		static constexpr uint8_t no_call_conv = 0xFF;
+
+		struct TypeNode {
+			TypeKind kind;
+			uint8_t call_conv; // CallConvention, or no_call_conv
+			uint8_t has_decl;
+			uint8_t reserved;
+			uint32_t flags;
+			uint32_t primitive; // Type::Primitive, for TypeKind::Primitive
+			String decl;
+			Ref base; // TypeNode, ProtoNode or RecordNode, by kind
+		};
+
+		struct ArgNode {
+			ArgKind kind;
+			uint8_t reserved[3];
+			Ref type;
+			String name;
+		};
+
+		struct ProtoNode {
+			String name;
+			Ref ret; // TypeNode
+			uint32_t arg_count;
+			Ref args; // arg_count consecutive ArgNodes
+		};
+
+		struct MemberNode {
+			Ref type;
+			String name;
+		};
+
+		struct RecordNode {
+			String tag;
+			uint8_t is_union;
+			uint8_t complete;
+			uint8_t reserved[2];
+			uint32_t pack;
+			uint32_t member_count;
+			Ref members; // member_count consecutive MemberNodes
+		};
+
+		struct Header {
+			char magic[8];
+			uint32_t version;
+			uint32_t char_size; // sizeof(char_t) of the writer
+			uint64_t size; // Of the whole file
+			uint64_t checksum; // FNV-1a of the whole file, with this field zeroed
+			uint32_t type_count;
+			uint32_t proto_count;
+			Ref protos; // proto_count Refs to ProtoNodes, sorted by name
+			uint32_t reserved;
+		};
+
+		// The value Header::checksum should hold for a whole file
+		uint64_t Checksum(const unsigned char* data, size_t size);
+	}
+
+	/*
+	 * Serializes parsed prototypes into the TypeDbFormat.
+	 * Types, protos, records and strings are all deduplicated structurally, so each distinct node is written once.
+	 */
+	class TypeDbWriter {
+		std::vector<unsigned char> m_data;
+		std::unordered_map<string, uint32_t> m_strings;
+		std::unordered_map<std::string, uint32_t> m_nodes; // Node bytes, with absolute refs, to its offset
+		std::vector<std::pair<string, uint32_t>> m_protos;
+		uint32_t m_type_count = 0;
+
+		TypeDbFormat::String WriteString(string_view str);
+		uint32_t WriteType(const Type& type);
+		uint32_t WriteProto(const FunctionProto& proto);
+		uint32_t WriteRecord(const Record& record);
+		TypeDbFormat::ArgNode MakeArg(const Argument& arg);
+
+		// Appends `nodes` once per distinct content and returns the offset of the first. Refs are absolute until written.
+		template <class TNode>
+		uint32_t Emit(const TNode* nodes, size_t count);
+
+	public:
+		TypeDbWriter();
+
+		// Adds a prototype to the name index, along with everything it references
+		void Add(const FunctionProto& proto);
+
+		// Finishes the file and resets the writer
+		std::vector<unsigned char> Finish();
+		std::optional<string> Save(const char* path);
+	};
+
+	/*
+	 * A type database queried in place. Views point straight into the mapping and must not outlive the TypeDb.
+	 * Opening is O(1) apart from the optional checksum pass; nothing is deserialized.
+	 */
+	class TypeDb {
+		template <class T>
+		static const T* Resolve(const TypeDbFormat::Ref& ref) {
+			return ref.rel ? (const T*)((const unsigned char*)&ref + ref.rel) : nullptr;
+		}
+		static string_view Resolve(const TypeDbFormat::String& str) {
+			return str.length ? string_view(Resolve<char_t>(str.data), str.length) : string_view();
+		}
+
+	public:
+		class ProtoView;
+		class RecordView;
+
+		using OpenResult = Result<std::shared_ptr<const TypeDb>, string>;
+
+		class TypeView {
+			const TypeDbFormat::TypeNode* m_node;
+
+		public:
+			TypeView(const TypeDbFormat::TypeNode* node) : m_node(node) {}
+
+			bool IsPointer() const { return m_node->flags & TypeDbFormat::Pointer; }
+			bool IsPrimitive() const { return m_node->kind == TypeDbFormat::TypeKind::Primitive; }
+			bool IsFunctionProto() const { return m_node->kind == TypeDbFormat::TypeKind::Proto; }
+			bool IsRecord() const { return m_node->kind == TypeDbFormat::TypeKind::Record; }
+
+			bool IsConst() const { return m_node->flags & TypeDbFormat::Const; }
+			bool IsVolatile() const { return m_node->flags & TypeDbFormat::Volatile; }
+			bool IsLong() const { return m_node->flags & TypeDbFormat::Long; }
+			bool IsLongLong() const { return m_node->flags & TypeDbFormat::LongLong; }
+			bool IsShort() const { return m_node->flags & TypeDbFormat::Short; }
+			bool IsUnsigned() const { return m_node->flags & TypeDbFormat::Unsigned; }
+			bool HasCallConvention() const { return m_node->call_conv != TypeDbFormat::no_call_conv; }
+			bool HasDecl() const { return m_node->has_decl; }
+
+			Type::Primitive GetPrimitiveType() const { return (Type::Primitive)m_node->primitive; }
+			TypeView GetPointedType() const { return TypeView(Resolve<TypeDbFormat::TypeNode>(m_node->base)); }
+			ProtoView GetFunctionProto() const;
+			RecordView GetRecord() const;
+
+			CallConvention GetConvention() const { return (CallConvention)m_node->call_conv; }
+			string_view GetDecl() const { return Resolve(m_node->decl); }
+
+			// Nodes are deduplicated, so equal types have equal identities within one database
+			const void* Identity() const { return m_node; }
+		};
+
+		class ArgView {
+			const TypeDbFormat::ArgNode* m_node;
+
+		public:
+			ArgView(const TypeDbFormat::ArgNode* node) : m_node(node) {}
+
+			bool IsType() const { return m_node->kind == TypeDbFormat::ArgKind::Type; }
+			bool IsVariable() const { return m_node->kind == TypeDbFormat::ArgKind::Variable; }
+			bool IsVariadic() const { return m_node->kind == TypeDbFormat::ArgKind::Variadic; }
+
+			TypeView GetType() const { return TypeView(Resolve<TypeDbFormat::TypeNode>(m_node->type)); }
+			string_view GetName() const { return Resolve(m_node->name); }
+		};
+
+		class ProtoView {
+			const TypeDbFormat::ProtoNode* m_node;
+
+		public:
+			ProtoView(const TypeDbFormat::ProtoNode* node) : m_node(node) {}
+
+			string_view GetName() const { return Resolve(m_node->name); }
+			TypeView GetReturnType() const { return TypeView(Resolve<TypeDbFormat::TypeNode>(m_node->ret)); }
+
+			size_t ArgCount() const { return m_node->arg_count; }
+			ArgView GetArg(size_t i) const { return ArgView(Resolve<TypeDbFormat::ArgNode>(m_node->args) + i); }
+
+			bool HasDecl() const { return GetReturnType().HasDecl(); }
+			string_view GetDecl() const { return GetReturnType().GetDecl(); }
+
+			CallConvention GetConventionOrDefault(CallConvention default_) const {
+				TypeView ret = GetReturnType();
+				return ret.HasCallConvention() ? ret.GetConvention() : default_;
+			}
+		};
+
+		class RecordView {
+			const TypeDbFormat::RecordNode* m_node;
+
+		public:
+			RecordView(const TypeDbFormat::RecordNode* node) : m_node(node) {}
+
+			string_view GetTag() const { return Resolve(m_node->tag); }
+			bool IsUnion() const { return m_node->is_union; }
+			bool IsComplete() const { return m_node->complete; }
+			uint32_t GetPack() const { return m_node->pack; }
+
+			size_t MemberCount() const { return m_node->member_count; }
+			TypeView GetMemberType(size_t i) const { return TypeView(Resolve<TypeDbFormat::TypeNode>(Members()[i].type)); }
+			string_view GetMemberName(size_t i) const { return Resolve(Members()[i].name); }
+
+		private:
+			const TypeDbFormat::MemberNode* Members() const { return Resolve<TypeDbFormat::MemberNode>(m_node->members); }
+		};
+
+	private:
+		std::shared_ptr<const MappedFile> m_file;
+		std::vector<unsigned char> m_owned;
+		const TypeDbFormat::Header* m_header = nullptr;
+		const TypeDbFormat::Ref* m_protos = nullptr;
+
+		TypeDb() = default;
+
+		static OpenResult Validate(std::shared_ptr<TypeDb> db, const unsigned char* data, size_t size, bool verify);
+
+	public:
+		TypeDb(const TypeDb&) = delete;
+		TypeDb& operator=(const TypeDb&) = delete;
+
+		/*
+		 * verify: Check the checksum, and that every node reachable from the proto table lies inside the file.
+		 * This reads the whole file once. Without it only the header and proto table are checked, so only skip it for trusted files.
+		 */
+		static OpenResult Open(const char* path, bool verify = true);
+		static OpenResult Load(std::vector<unsigned char>&& data, bool verify = true);
+
+		size_t ProtoCount() const { return m_header->proto_count; }
+		size_t TypeCount() const { return m_header->type_count; }
+
+		// Protos are sorted by name
+		ProtoView GetProto(size_t i) const { return ProtoView(Resolve<TypeDbFormat::ProtoNode>(m_protos[i])); }
+
+		// O(log n). If several protos share the name, returns the first added.
+		std::optional<ProtoView> FindProto(string_view name) const;
+	};
+
+	inline TypeDb::ProtoView TypeDb::TypeView::GetFunctionProto() const {
+		return ProtoView(Resolve<TypeDbFormat::ProtoNode>(m_node->base));
+	}
+
+	inline TypeDb::RecordView TypeDb::TypeView::GetRecord() const {
+		return RecordView(Resolve<TypeDbFormat::RecordNode>(m_node->base));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cdecl/util.hpp>
+#include "type.hpp"
+#include "typetable.hpp"
+
+namespace Cdecl {
+	/*
+	 * Typedef scope mapping type names to their types, for ParseContext::typedefs.
+	 * Names live in a flat open-addressing table. Find() never locks, so any number of parser threads can resolve names
+	 * while another thread defines new ones. Writers are serialized.
+	 *
+	 * Defined types are canonicalized through the table's own TypeTable, so repeating an identical typedef is allowed.
+	 * Names are copied into that TypeTable's string pool.
+	 */
+	class TypedefTable {
+		struct Entry {
+			string_view name; // Interned
+			size_t hash;
+			std::shared_ptr<const Type> type;
+		};
+
+		struct Table {
+			size_t mask;
+			std::unique_ptr<std::atomic<const Entry*>[]> slots;
+		};
+
+		std::atomic<const Table*> m_table;
+		std::atomic<size_t> m_count = 0;
+
+		std::mutex m_write_mutex;
+		std::deque<Entry> m_entries;
+		std::vector<std::unique_ptr<Table>> m_tables; // Every table ever published, since readers may still be probing an old one
+		TypeTable m_types;
+
+		static size_t Hash(const string_view& name) { return std::hash<string_view>()(name); }
+		void Publish(size_t slot_count);
+
+	public:
+		TypedefTable(size_t capacity = 256);
+		TypedefTable(const TypedefTable&) = delete;
+		TypedefTable& operator=(const TypedefTable&) = delete;
+
+		// Returns false if name already names a different type
+		bool Define(const string_view& name, const std::shared_ptr<const Type>& type);
+
+		// Returns nullptr if name isn't a typedef
+		std::shared_ptr<const Type> Find(const string_view& name) const;
+
+		size_t Size() const { return m_count.load(); }
+
+		/*
+		 * Parses `typedef <type> <name>`, without the ';', and defines it.
+		 * Returns the interned name. Without ParseContext::types, the type is parsed into the table's own TypeTable
+		 * so that it lives as long as the table.
+		 */
+		using ParseResult = Result<std::pair<string_view, TokenCursor>, ParseError>;
+		ParseResult ParseTypedef(TokenCursor cur, const ParseContext& ctx = ParseContext());
+	};
+}
\ No newline at end of file
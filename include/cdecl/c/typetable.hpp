@@ -0,0 +1,62 @@
+#pragma once
+#include <array>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <unordered_map>
+#include <cdecl/stringpool.hpp>
+#include "type.hpp"
+
+namespace Cdecl {
+	/*
+	 * Hash-consing table that keeps one canonical node per structurally identical Type.
+	 * Two types are identical when their primitive/pointee/proto, flags, call convention and decl all match.
+	 * Pointees and protos are compared by identity, so nested types should be interned through the same table.
+	 *
+	 * Every canonical node also gets a compact id. Safe to use from many threads at once.
+	 * Names in interned nodes must live as long as the table, so parsers without a string pool intern them in GetStrings().
+	 */
+	class TypeTable {
+	public:
+		using typeid_t = uint32_t;
+
+	private:
+		static constexpr size_t shard_count = 16;
+
+		struct NodeHash {
+			size_t operator()(const Type* type) const { return Hash(*type); }
+		};
+		struct NodeEqual {
+			bool operator()(const Type* a, const Type* b) const { return Equal(*a, *b); }
+		};
+
+		struct Shard {
+			std::mutex mutex;
+			std::unordered_map<const Type*, typeid_t, NodeHash, NodeEqual> index;
+			std::deque<std::shared_ptr<const Type>> nodes;
+		};
+
+		std::array<Shard, shard_count> m_shards;
+		ConcurrentStringPool m_strings;
+
+		static size_t Hash(const Type& type);
+		static bool Equal(const Type& a, const Type& b);
+
+	public:
+		// Returns the canonical node equal to `type`, adding it if it is new
+		std::shared_ptr<const Type> Intern(Type&& type);
+
+		// Same as Intern, but also canonicalizes every pointee beneath `type`
+		std::shared_ptr<const Type> Intern(const std::shared_ptr<const Type>& type);
+
+		typeid_t InternId(Type&& type);
+
+		// Returns the id of a node previously returned by this table
+		std::optional<typeid_t> GetId(const Type& type);
+		std::shared_ptr<const Type> Get(typeid_t id);
+
+		size_t Size();
+
+		ConcurrentStringPool& GetStrings() { return m_strings; }
+	};
+}
\ No newline at end of file
@@ -1,9 +1,14 @@
-#pragma once
-
-namespace Cdecl
-{
-#ifndef CDECL_CHAR_TYPE
-	#define CDECL_CHAR_TYPE char
-#endif
-	using char_t = CDECL_CHAR_TYPE;
-}
\ No newline at end of file
+#pragma once
+
+namespace Cdecl
+{
+#ifndef CDECL_CHAR_TYPE
+	#define CDECL_CHAR_TYPE char
+#endif
+	using char_t = CDECL_CHAR_TYPE;
+}
+
+// 1 to count tokens, backtracks, allocations and phase times into ParseStats. Must match between the library and its users.
+#ifndef CDECL_PARSE_STATS
+	#define CDECL_PARSE_STATS 0
+#endif
\ No newline at end of file
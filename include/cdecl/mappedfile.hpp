@@ -0,0 +1,33 @@
+#pragma once
+#include <memory>
+#include "util.hpp"
+
+namespace Cdecl {
+	/*
+	 * Read-only memory map of a whole file.
+	 * The contents are viewed in place as char_t units, without being copied into a string.
+	 */
+	class MappedFile {
+		const void* m_data = nullptr;
+		size_t m_size = 0;
+#ifdef _WIN32
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+#else
+		int m_fd = -1;
+#endif
+
+		MappedFile() = default;
+
+	public:
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile();
+
+		string_view View() const { return string_view((const char_t*)m_data, m_size / sizeof(char_t)); }
+		size_t SizeInBytes() const { return m_size; }
+
+		using OpenResult = Result<std::shared_ptr<const MappedFile>, string>;
+		static OpenResult Open(const char* path);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,250 @@
+#pragma once
+#include <thread>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <optional>
+#include "util.hpp"
+#include "scan.hpp"
+#include "tokenizer.hpp"
+#include "parsestats.hpp"
+
+namespace Cdecl {
+	/*
+	 * Multithreaded versions of TokenizeAll and TokenizeBuffer for large inputs.
+	 * The input is cut at whitespace into one chunk per thread, and the chunks are tokenized concurrently.
+	 * Results are stitched back in order, so tokens and errors are identical to the serial functions.
+	 *
+	 * This relies on no token containing whitespace, which holds for the built-in C tokens.
+	 * parse_at is called from several threads at once. Tokenizer::ParseAt and Lexer::ParseAt are both safe for this.
+	 */
+	namespace Parallel {
+		constexpr size_t default_min_chunk = 1 << 16;
+
+		// Cuts str into at most `count` pieces, each ending just before a whitespace char
+		inline std::vector<string_view> SplitAtWhitespace(const string_view& str, size_t count, size_t min_chunk) {
+			std::vector<string_view> chunks;
+			size_t begin = 0;
+
+			for (size_t i = 1; i < count && begin < str.length(); ++i) {
+				size_t target = std::max(str.length() * i / count, begin + min_chunk);
+				size_t split = target;
+				while (split < str.length() && !Scan::IsWhitespace(str[split]))
+					++split;
+				if (split >= str.length())
+					break;
+
+				chunks.push_back(str.substr(begin, split - begin));
+				begin = split;
+			}
+
+			chunks.push_back(str.substr(begin));
+			return chunks;
+		}
+
+		inline size_t ResolveThreads(size_t threads) {
+			if (threads)
+				return threads;
+			size_t hw = std::thread::hardware_concurrency();
+			return hw ? hw : 1;
+		}
+
+		/*
+		 * Worker threads kept alive between RunChunks calls, so a batch doesn't pay to start threads every time.
+		 * Threads are only started when a call wants more helpers than the pool has, and they live until exit.
+		 */
+		class ThreadPool {
+			std::mutex m_mutex;
+			std::condition_variable m_wake;
+			std::deque<std::function<void()>> m_tasks;
+			std::vector<std::thread> m_threads;
+			bool m_stop = false;
+
+			void Work() {
+				std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(m_mutex);
+				for (;;) {
+					m_wake.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+					if (m_tasks.empty())
+						return;
+
+					std::function<void()> task = std::move(m_tasks.front());
+					m_tasks.pop_front();
+					lock.unlock();
+					task();
+					lock.lock();
+				}
+			}
+
+		public:
+			ThreadPool() = default;
+			ThreadPool(const ThreadPool&) = delete;
+			ThreadPool& operator=(const ThreadPool&) = delete;
+
+			~ThreadPool() {
+				{
+					std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(m_mutex);
+					m_stop = true;
+				}
+				m_wake.notify_all();
+				for (std::thread& thread : m_threads)
+					thread.join();
+			}
+
+			static ThreadPool& Shared() {
+				static ThreadPool pool;
+				return pool;
+			}
+
+			// Queues `count` runs of task, first starting threads until there are at least `count`
+			void Post(size_t count, const std::function<void()>& task) {
+				{
+					std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(m_mutex);
+					while (m_threads.size() < count)
+						m_threads.emplace_back([this]() { Work(); });
+					for (size_t i = 0; i < count; ++i)
+						m_tasks.push_back(task);
+				}
+				m_wake.notify_all();
+			}
+		};
+
+		/*
+		 * Runs fn(index) once for each index in [0, count), with up to `count` threads at once: the calling thread
+		 * and count - 1 helpers from ThreadPool::Shared(). Every thread claims indices from one counter, so an index
+		 * never runs on two threads and the caller finishes the job alone if the pool is busy, e.g. in a nested call.
+		 * ParseStats counted by the helpers are added to the calling thread's.
+		 */
+		template <class TFn>
+		inline void RunChunks(size_t count, TFn fn) {
+			if (count <= 1) {
+				if (count)
+					fn(0);
+				return;
+			}
+
+			// Shared with the helpers, which may only get to run after this call has returned
+			struct Job {
+				std::atomic<size_t> next { 0 };
+				size_t done = 0;
+				std::mutex mutex;
+				std::condition_variable finished;
+				Stats::Collector stats;
+			};
+			std::shared_ptr<Job> job = std::make_shared<Job>();
+
+			// fn is only called for a claimed index, and this call waits for those, so late helpers never touch it
+			auto claim = [count, &fn](Job& job) {
+				size_t ran = 0;
+				for (size_t i = job.next++; i < count; i = job.next++) {
+					fn(i);
+					++ran;
+				}
+				return ran;
+			};
+
+			ThreadPool::Shared().Post(count - 1, [job, claim, count]() {
+				ParseStats before = ParseStats::Local();
+				size_t ran = claim(*job);
+				if (!ran)
+					return;
+
+				job->stats.AddWorker(before);
+				std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(job->mutex);
+				job->done += ran;
+				if (job->done == count)
+					job->finished.notify_one();
+			});
+
+			size_t ran = claim(*job);
+			std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(job->mutex);
+			job->done += ran;
+			job->finished.wait(lock, [&]() { return job->done == count; });
+			job->stats.Finish();
+		}
+
+		/*
+		 * threads: 0 uses every hardware thread.
+		 * min_chunk: Inputs are never cut into chunks smaller than this, since threads cost more than they save on small inputs.
+		 */
+		template <class TParseAt>
+		inline Result<std::vector<Token>, std::string> TokenizeAll(
+			const string_view& str, TParseAt parse_at, size_t threads = 0, size_t min_chunk = default_min_chunk
+		) {
+			using ParseResult = Result<std::vector<Token>, std::string>;
+
+			std::vector<string_view> chunks = SplitAtWhitespace(str, ResolveThreads(threads), min_chunk);
+			if (chunks.size() == 1)
+				return Cdecl::TokenizeAll(str, parse_at);
+
+			std::vector<std::vector<Token>> tokens(chunks.size());
+			std::vector<std::optional<size_t>> errors(chunks.size());
+
+			RunChunks(chunks.size(), [&](size_t i) {
+				errors[i] = TokenizeWith(chunks[i], parse_at, [&](Token&& tk) { tokens[i].emplace_back(std::move(tk)); });
+			});
+
+			size_t total = 0;
+			for (size_t i = 0; i < chunks.size(); ++i) {
+				if (errors[i].has_value())
+					return ParseResult::Err{ UnknownTokenError(str, chunks[i].data() - str.data() + errors[i].value()) };
+				total += tokens[i].size();
+			}
+
+			std::vector<Token> buffer;
+			buffer.reserve(total);
+			for (std::vector<Token>& chunk_tokens : tokens)
+				buffer.insert(buffer.end(), chunk_tokens.begin(), chunk_tokens.end());
+			return ParseResult::Ok{ std::move(buffer) };
+		}
+
+		template <class TParseAt>
+		inline Result<TokenBuffer, std::string> TokenizeBuffer(
+			const string_view& str, TParseAt parse_at, size_t threads = 0, size_t min_chunk = default_min_chunk
+		) {
+			using ParseResult = Result<TokenBuffer, std::string>;
+
+			std::vector<string_view> chunks = SplitAtWhitespace(str, ResolveThreads(threads), min_chunk);
+			if (chunks.size() == 1)
+				return Cdecl::TokenizeBuffer(str, parse_at);
+			if (!TokenBuffer::FitsSource(str))
+				return ParseResult::Err{ Format("Input of ", str.length(), " chars is too large for a TokenBuffer").str() };
+
+			std::vector<TokenBuffer> buffers(chunks.size(), TokenBuffer(str));
+			std::vector<std::optional<size_t>> errors(chunks.size());
+			std::vector<std::optional<tokenid_t>> bad_ids(chunks.size());
+
+			RunChunks(chunks.size(), [&](size_t i) {
+				errors[i] = TokenizeWith(chunks[i], parse_at, [&](Token&& tk) {
+					if (TokenBuffer::FitsId(tk.id))
+						buffers[i].Push(tk.id, tk.view);
+					else if (!bad_ids[i].has_value())
+						bad_ids[i] = tk.id;
+				});
+			});
+
+			// Report the same error the serial tokenizer would hit first
+			for (size_t i = 0; i < chunks.size(); ++i) {
+				if (errors[i].has_value())
+					return ParseResult::Err{ UnknownTokenError(str, chunks[i].data() - str.data() + errors[i].value()) };
+			}
+			for (size_t i = 0; i < chunks.size(); ++i) {
+				if (bad_ids[i].has_value())
+					return ParseResult::Err{ Format("Token id ", bad_ids[i].value(), " is too large for a TokenBuffer").str() };
+			}
+
+			TokenBuffer buffer = TokenBuffer(str);
+			size_t total = 0;
+			for (const TokenBuffer& chunk_buffer : buffers)
+				total += chunk_buffer.Size();
+			buffer.Reserve(total);
+			for (const TokenBuffer& chunk_buffer : buffers)
+				buffer.Append(chunk_buffer);
+			return ParseResult::Ok{ std::move(buffer) };
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+#pragma once
+#include "config.hpp"
+#include <cstdint>
+#include <chrono>
+#include <mutex>
+
+namespace Cdecl {
+	/*
+	 * Counters for where tokenizing and parsing spend their time.
+	 * Every thread accumulates into its own ParseStats::Local(). To measure one parse or batch, snapshot it before
+	 * and subtract afterwards. Work done by Parallel::RunChunks helpers is added to the calling thread before the call returns.
+	 *
+	 * Counting only happens when CDECL_PARSE_STATS is defined to 1, for the library and its users alike.
+	 * Otherwise every hook below is an empty inline function and the counters stay zero.
+	 */
+	struct ParseStats {
+		enum Phase : size_t {
+			Lex,
+			Parse,
+			PhaseCount
+		};
+
+		uint64_t tokens = 0;
+		uint64_t defs_tried = 0; // TokenDefs considered by Tokenizer::ParseAt. Lexer looks tokens up directly.
+		uint64_t backtracks = 0; // TokenCursor and TokenStream seeks to an earlier position
+		uint64_t allocations = 0; // Type, Record and FunctionProto nodes from make_shared. Arena nodes and TypeTable hits are free.
+		uint64_t errors = 0; // ParseErrors and tokenizer errors constructed, including ones a caller discards
+		uint64_t phase_ns[PhaseCount] = {}; // Outermost calls only, summed across threads
+
+		ParseStats& operator+=(const ParseStats& other) {
+			tokens += other.tokens;
+			defs_tried += other.defs_tried;
+			backtracks += other.backtracks;
+			allocations += other.allocations;
+			errors += other.errors;
+			for (size_t i = 0; i < PhaseCount; ++i)
+				phase_ns[i] += other.phase_ns[i];
+			return *this;
+		}
+
+		ParseStats& operator-=(const ParseStats& other) {
+			tokens -= other.tokens;
+			defs_tried -= other.defs_tried;
+			backtracks -= other.backtracks;
+			allocations -= other.allocations;
+			errors -= other.errors;
+			for (size_t i = 0; i < PhaseCount; ++i)
+				phase_ns[i] -= other.phase_ns[i];
+			return *this;
+		}
+
+		friend ParseStats operator+(ParseStats a, const ParseStats& b) { return a += b; }
+		friend ParseStats operator-(ParseStats a, const ParseStats& b) { return a -= b; }
+
+		static constexpr bool enabled = CDECL_PARSE_STATS;
+
+		// This thread's running totals
+		static ParseStats& Local() {
+			static thread_local ParseStats stats;
+			return stats;
+		}
+	};
+
+	namespace Stats {
+#if CDECL_PARSE_STATS
+		inline void Count(uint64_t ParseStats::* counter, uint64_t n = 1) {
+			ParseStats::Local().*counter += n;
+		}
+
+		// Times a phase into ParseStats::Local(), unless an outer timer is already timing the same phase
+		class PhaseTimer {
+			using clock = std::chrono::steady_clock;
+
+			ParseStats::Phase m_phase;
+			bool m_outermost;
+			clock::time_point m_begin;
+
+			static uint32_t& Depth(ParseStats::Phase phase) {
+				static thread_local uint32_t depth[ParseStats::PhaseCount] = {};
+				return depth[phase];
+			}
+
+		public:
+			PhaseTimer(ParseStats::Phase phase) : m_phase(phase), m_outermost(Depth(phase)++ == 0) {
+				if (m_outermost)
+					m_begin = clock::now();
+			}
+
+			~PhaseTimer() {
+				--Depth(m_phase);
+				if (m_outermost)
+					ParseStats::Local().phase_ns[m_phase] += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - m_begin).count();
+			}
+
+			PhaseTimer(const PhaseTimer&) = delete;
+			PhaseTimer& operator=(const PhaseTimer&) = delete;
+		};
+
+		// Gathers the totals of worker threads so the thread that started them can add them to its own
+		class Collector {
+			ParseStats m_total;
+			std::mutex m_mutex;
+
+		public:
+			// Call on a worker thread once its share is done, with its ParseStats::Local() from before it started
+			void AddWorker(const ParseStats& before) {
+				std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(m_mutex);
+				m_total += ParseStats::Local() - before;
+			}
+
+			// Call on the starting thread once every worker is done
+			void Finish() { ParseStats::Local() += m_total; }
+		};
+#else
+		inline void Count(uint64_t ParseStats::*, uint64_t = 1) {}
+
+		class PhaseTimer {
+		public:
+			PhaseTimer(ParseStats::Phase) {}
+			~PhaseTimer() {} // Non-trivial, so locals that only exist to be timed don't warn as unused
+		};
+
+		class Collector {
+		public:
+			void AddWorker(const ParseStats&) {}
+			void Finish() {}
+		};
+#endif
+	}
+}
\ No newline at end of file
@@ -0,0 +1,154 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+#include "util.hpp"
+
+#if !defined(CDECL_NO_SIMD)
+	#if defined(__AVX2__)
+		#define CDECL_SCAN_AVX2
+	#endif
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define CDECL_SCAN_SSE2
+	#endif
+#endif
+
+#if defined(CDECL_SCAN_AVX2)
+	#include <immintrin.h>
+#elif defined(CDECL_SCAN_SSE2)
+	#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+/*
+ * Character class scanning for the tokenizer.
+ * Classifies 32 (AVX2) or 16 (SSE2) chars at a time when char_t is a single byte, with a scalar fallback for the rest.
+ * Classes are ASCII only and never consult the C locale.
+ */
+
+namespace Cdecl {
+	namespace Scan {
+		inline bool IsWhitespace(char_t ch) {
+			return ch == ' ' || (ch >= '\t' && ch <= '\r');
+		}
+
+		inline bool IsIdentifierStart(char_t ch) {
+			return IsIdentifierChar(ch) && !(ch >= '0' && ch <= '9');
+		}
+
+		inline unsigned CountTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER)
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return (unsigned)index;
+#else
+			return (unsigned)__builtin_ctz(mask);
+#endif
+		}
+
+		namespace Detail {
+			template <class TPred>
+			inline size_t ScalarRun(const char_t* begin, size_t pos, size_t len, TPred pred) {
+				while (pos < len && pred(begin[pos]))
+					++pos;
+				return pos;
+			}
+
+#if defined(CDECL_SCAN_AVX2)
+			inline __m256i InRange(__m256i v, char lo, char count) {
+				// Unsigned (v - lo) <= count
+				__m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8(lo));
+				return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(count)), shifted);
+			}
+
+			inline uint32_t WhitespaceMask(const char* p) {
+				__m256i v = _mm256_loadu_si256((const __m256i*)p);
+				__m256i space = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+				return (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(space, InRange(v, '\t', '\r' - '\t')));
+			}
+
+			inline uint32_t IdentifierMask(const char* p) {
+				__m256i v = _mm256_loadu_si256((const __m256i*)p);
+				__m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+				__m256i alpha = InRange(lower, 'a', 'z' - 'a');
+				__m256i digit = InRange(v, '0', '9' - '0');
+				__m256i under = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+				return (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(alpha, digit), under));
+			}
+
+			constexpr size_t block_size = 32;
+			constexpr uint32_t block_full = 0xFFFFFFFF;
+#elif defined(CDECL_SCAN_SSE2)
+			inline __m128i InRange(__m128i v, char lo, char count) {
+				// Unsigned (v - lo) <= count
+				__m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(lo));
+				return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(count)), shifted);
+			}
+
+			inline uint32_t WhitespaceMask(const char* p) {
+				__m128i v = _mm_loadu_si128((const __m128i*)p);
+				__m128i space = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+				return (uint32_t)_mm_movemask_epi8(_mm_or_si128(space, InRange(v, '\t', '\r' - '\t')));
+			}
+
+			inline uint32_t IdentifierMask(const char* p) {
+				__m128i v = _mm_loadu_si128((const __m128i*)p);
+				__m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+				__m128i alpha = InRange(lower, 'a', 'z' - 'a');
+				__m128i digit = InRange(v, '0', '9' - '0');
+				__m128i under = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+				return (uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(alpha, digit), under));
+			}
+
+			constexpr size_t block_size = 16;
+			constexpr uint32_t block_full = 0xFFFF;
+#endif
+
+			template <class TMask, class TPred>
+			inline size_t Run(const string_view& str, TMask mask_fn, TPred pred) {
+				const char_t* begin = str.data();
+				const size_t len = str.length();
+				size_t pos = 0;
+
+#if defined(CDECL_SCAN_AVX2) || defined(CDECL_SCAN_SSE2)
+				if constexpr (sizeof(char_t) == 1) {
+					// Most runs are short, so check the first char before paying for a block load
+					if (len == 0 || !pred(begin[0]))
+						return 0;
+
+					while (pos + block_size <= len) {
+						uint32_t mask = mask_fn((const char*)begin + pos);
+						if (mask != block_full)
+							return pos + CountTrailingZeros(~mask);
+						pos += block_size;
+					}
+				}
+#endif
+				return ScalarRun(begin, pos, len, pred);
+			}
+		}
+
+		/*
+		 * Length of the whitespace run at the start of str
+		 */
+		inline size_t Whitespace(const string_view& str) {
+#if defined(CDECL_SCAN_AVX2) || defined(CDECL_SCAN_SSE2)
+			return Detail::Run(str, Detail::WhitespaceMask, IsWhitespace);
+#else
+			return Detail::ScalarRun(str.data(), 0, str.length(), IsWhitespace);
+#endif
+		}
+
+		/*
+		 * Length of the [A-Za-z0-9_] run at the start of str
+		 */
+		inline size_t IdentifierChars(const string_view& str) {
+#if defined(CDECL_SCAN_AVX2) || defined(CDECL_SCAN_SSE2)
+			return Detail::Run(str, Detail::IdentifierMask, IsIdentifierChar);
+#else
+			return Detail::ScalarRun(str.data(), 0, str.length(), IsIdentifierChar);
+#endif
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+#include <array>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include "util.hpp"
+#include "arena.hpp"
+
+namespace Cdecl {
+	using symbol_t = uint32_t;
+
+	/*
+	 * Interns strings so each distinct name is stored once.
+	 * Returned views and ids stay valid for the lifetime of the pool. Not thread-safe; see ConcurrentStringPool.
+	 */
+	class StringPool {
+		Arena m_text;
+		std::unordered_map<string_view, symbol_t> m_index;
+		std::vector<string_view> m_strings;
+
+	public:
+		StringPool() : m_text(16 * 1024) {}
+
+		// Returns the id of str and its pooled copy
+		std::pair<symbol_t, string_view> Insert(const string_view& str) {
+			auto it = m_index.find(str);
+			if (it != m_index.end())
+				return { it->second, m_strings[it->second] };
+
+			string_view copy = m_text.Copy(str);
+			symbol_t id = (symbol_t)m_strings.size();
+			m_strings.push_back(copy);
+			m_index.emplace(copy, id);
+			return { id, copy };
+		}
+
+		string_view Intern(const string_view& str) { return Insert(str).second; }
+		symbol_t InternId(const string_view& str) { return Insert(str).first; }
+
+		string_view Get(symbol_t id) const { return id < m_strings.size() ? m_strings[id] : string_view(); }
+		size_t Size() const { return m_strings.size(); }
+	};
+
+	/*
+	 * Thread-safe StringPool, split into independently locked shards
+	 */
+	class ConcurrentStringPool {
+		static constexpr size_t shard_count = 16;
+
+		struct Shard {
+			std::mutex mutex;
+			StringPool pool;
+		};
+
+		std::array<Shard, shard_count> m_shards;
+
+	public:
+		std::pair<symbol_t, string_view> Insert(const string_view& str) {
+			size_t shard_index = std::hash<string_view>()(str) % shard_count;
+			Shard& shard = m_shards[shard_index];
+			std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(shard.mutex);
+
+			std::pair<symbol_t, string_view> result = shard.pool.Insert(str);
+			result.first = (symbol_t)(result.first * shard_count + shard_index);
+			return result;
+		}
+
+		string_view Intern(const string_view& str) { return Insert(str).second; }
+		symbol_t InternId(const string_view& str) { return Insert(str).first; }
+
+		string_view Get(symbol_t id) {
+			Shard& shard = m_shards[id % shard_count];
+			std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(shard.mutex);
+			return shard.pool.Get((symbol_t)(id / shard_count));
+		}
+
+		size_t Size() {
+			size_t size = 0;
+			for (Shard& shard : m_shards) {
+				std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(shard.mutex);
+				size += shard.pool.Size();
+			}
+			return size;
+		}
+	};
+}
\ No newline at end of file
@@ -1,97 +1,112 @@
-#pragma once
-#include "tokenizer.hpp"
-
-namespace Cdecl {
-	class TokenCursor {
-		const Token* m_begin, * m_end;
-		size_t m_pos = 0;
-
-		const Token* MatchAny() { return nullptr; }
-
-	public:
-		TokenCursor(const Token* begin, const Token* end) : m_begin(begin), m_end(end) {}
-		TokenCursor(const std::vector<Token>& tokens) : TokenCursor(&tokens.front(), &tokens.back() + 1) {}
-
-		size_t Pos() const { return m_pos; }
-
-		template <class ...TArgs>
-		stringstream FormatWithLoc(size_t start_pos, TArgs... args) const {
-			stringstream ss;
-
-			ss << '"';
-			size_t count = 15;
-			for (size_t i = start_pos; count > 0 && m_begin + i < m_end; ++i) {
-				string_view view = m_begin[i].view;
-				if (view.length() < count) {
-					ss << view << ' ';
-					count -= view.length();
-				}
-				else {
-					ss << view.substr(0, count) << "...";
-					count = 0;
-				}
-			}
-			ss << '"';
-
-			size_t char_index = 0;
-			if (m_begin && m_begin != m_end) {
-				const char_t* begin = &m_begin->view.front();
-				if (m_begin + start_pos < m_end)
-					char_index = &m_begin[start_pos].view.front() - begin;
-				else
-					char_index = &(m_end - 1)->view.back() - begin;
-			}
-			ss << "(at char " << char_index << "): ";
-			return Format(std::move(ss), args...);
-		}
-
-		const Token* Peek() const {
-			if (m_begin + m_pos >= m_end)
-				return nullptr;
-			return &m_begin[m_pos];
-		}
-
-		const Token* Skip() {
-			const Token* tk = Peek();
-			if (tk)
-				++m_pos;
-			return tk;
-		}
-
-		bool Seek(size_t pos) {
-			if (m_begin + pos <= m_end) {
-				m_pos = pos;
-				return true;
-			}
-			return false;
-		}
-
-		const Token* Match(tokenid_t id) {
-			const Token* tk = Peek();
-			if (tk && tk->id == (tokenid_t)id) {
-				++m_pos;
-				return tk;
-			}
-			return nullptr;
-		}
-
-		template <class TId, class ...TMore>
-		const Token* MatchAny(TId id, TMore... more) {
-			const Token* tk = Match((tokenid_t)id);
-			return tk ? tk : MatchAny(more...);
-		}
-
-		bool MatchSequence() {
-			return true;
-		}
-
-		template <class TId, class ...TMore>
-		bool MatchSequence(TId id, TMore... more) {
-			size_t begin = Pos();
-			bool result = Match((tokenid_t)id) && MatchSequence(more...);
-			if (!result)
-				Seek(begin);
-			return result;
-		}
-	};
+#pragma once
+#include "tokenizer.hpp"
+
+namespace Cdecl {
+	class TokenCursor {
+		const TokenBuffer* m_tokens;
+		size_t m_pos = 0;
+
+		std::optional<Token> MatchAny() { return {}; }
+
+	public:
+		TokenCursor(const TokenBuffer& tokens) : m_tokens(&tokens) {}
+
+		size_t Pos() const { return m_pos; }
+
+		template <class ...TArgs>
+		stringstream FormatWithLoc(size_t start_pos, TArgs... args) const {
+			stringstream ss;
+			const size_t size = m_tokens->Size();
+
+			ss << '"';
+			size_t count = 15;
+			for (size_t i = start_pos; count > 0 && i < size; ++i) {
+				string_view view = m_tokens->View(i);
+				if (view.length() < count) {
+					ss << view << ' ';
+					count -= view.length();
+				}
+				else {
+					ss << view.substr(0, count) << "...";
+					count = 0;
+				}
+			}
+			ss << '"';
+
+			size_t char_index = 0;
+			if (size) {
+				size_t first = m_tokens->Offset(0);
+				if (start_pos < size)
+					char_index = m_tokens->Offset(start_pos) - first;
+				else
+					char_index = m_tokens->Offset(size - 1) + m_tokens->View(size - 1).length() - 1 - first;
+			}
+			ss << "(at char " << char_index << "): ";
+			return Format(std::move(ss), args...);
+		}
+
+		std::optional<Token> Peek() const {
+			if (m_pos >= m_tokens->Size())
+				return {};
+			return m_tokens->At(m_pos);
+		}
+
+		std::optional<Token> Skip() {
+			std::optional<Token> tk = Peek();
+			if (tk)
+				++m_pos;
+			return tk;
+		}
+
+		bool Seek(size_t pos) {
+			if (pos <= m_tokens->Size()) {
+				if (pos < m_pos)
+					Stats::Count(&ParseStats::backtracks);
+				m_pos = pos;
+				return true;
+			}
+			return false;
+		}
+
+		std::optional<Token> Match(tokenid_t id) {
+			if (m_pos < m_tokens->Size() && m_tokens->Id(m_pos) == id)
+				return m_tokens->At(m_pos++);
+			return {};
+		}
+
+		// TSet is any set with Contains(tokenid_t), e.g. a TokenSet. One lookup instead of one Match per id.
+		template <class TSet>
+		std::optional<Token> PeekClass(const TSet& set) const {
+			if (m_pos < m_tokens->Size() && set.Contains(m_tokens->Id(m_pos)))
+				return m_tokens->At(m_pos);
+			return {};
+		}
+
+		template <class TSet>
+		std::optional<Token> MatchClass(const TSet& set) {
+			std::optional<Token> tk = PeekClass(set);
+			if (tk)
+				++m_pos;
+			return tk;
+		}
+
+		template <class TId, class ...TMore>
+		std::optional<Token> MatchAny(TId id, TMore... more) {
+			std::optional<Token> tk = Match((tokenid_t)id);
+			return tk ? tk : MatchAny(more...);
+		}
+
+		bool MatchSequence() {
+			return true;
+		}
+
+		template <class TId, class ...TMore>
+		bool MatchSequence(TId id, TMore... more) {
+			size_t begin = Pos();
+			bool result = Match((tokenid_t)id) && MatchSequence(more...);
+			if (!result)
+				Seek(begin);
+			return result;
+		}
+	};
 }
\ No newline at end of file
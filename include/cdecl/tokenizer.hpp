@@ -1,113 +1,271 @@
-#pragma once
-#include <cstdint>
-#include <vector>
-#include <string>
-#include <optional>
-#include <variant>
-#include "util.hpp"
-#include "stringcursor.hpp"
-
-namespace Cdecl {
-	using tokenid_t = uint32_t;
-
-	struct Token {
-		const tokenid_t id;
-		const string_view view;
-
-		Token(tokenid_t id_, string_view&& view_) : id(id_), view(view_) {}
-	};
-
-	struct TokenDef {
-		enum class Kind {
-			Static,
-			Dynamic
-		};
-
-		struct Static {
-			enum Flag : uint32_t {
-				Keyword = 1 << 0,
-				CaseInsensitive = 1 << 1,
-			};
-
-			const tokenid_t id;
-			const std::basic_string<char_t> str;
-			const uint32_t flags = 0;
-
-			template <class ...T>
-			Static(tokenid_t id_, std::basic_string<char_t>&& str_, Flag flag, T... flags_)
-				: id(id_), str(str_), flags(CombineFlags(flag, flags_...)) {}
-			Static(tokenid_t id_, std::basic_string<char_t>&& str_) : id(id_), str(str_), flags(0) {}
-		};
-
-		struct Dynamic {
-			using callback_t = std::optional<Token>(StringCursor cursor);
-			callback_t* const callback;
-			Dynamic(callback_t* callback_) : callback(callback_) {}
-		};
-
-		const Kind kind;
-		const std::variant<Static, Dynamic> variant;
-
-		TokenDef(Static&& statik_) : kind(Kind::Static), variant(statik_) {}
-		TokenDef(Dynamic&& dynamic_) : kind(Kind::Dynamic), variant(dynamic_) {}
-
-		bool IsStatic() const { return std::holds_alternative<Static>(variant); }
-		bool IsDynamic() const { return std::holds_alternative<Dynamic>(variant); }
-
-		const Static& GetStatic() const { return std::get<Static>(variant); }
-		const Dynamic& GetDynamic() const { return std::get<Dynamic>(variant); }
-	};
-
-	class Tokenizer {
-		std::vector<TokenDef> m_defs;
-
-	public:
-		Tokenizer(std::vector<TokenDef>&& defs_) : m_defs(defs_) {}
-
-		using ParseResult = Result<std::vector<Token>, std::string>;
-
-		std::optional<Token> ParseAt(StringCursor cursor) const {
-			const char_t* begin = cursor.Peek();
-			if (!begin)
-				return std::optional<Token>();
-
-			for (const TokenDef& def : m_defs) {
-				if (def.IsStatic()) {
-					const TokenDef::Static& statik = def.GetStatic();
-					if (cursor.MatchString(statik.str))
-						return std::optional<Token>(Token(statik.id, string_view(begin, statik.str.length())));
-				}
-				else if (def.IsDynamic()) {
-					const TokenDef::Dynamic& dynamic = def.GetDynamic();
-					std::optional<Token> tk = dynamic.callback(cursor);
-					if (tk.has_value())
-						return tk;
-				}
-			}
-
-			return {};
-		}
-
-		ParseResult ParseAll(const string_view& str) const {
-			StringCursor cur = StringCursor(str);
-			std::vector<Token> buffer;
-
-			while (true) {
-				cur.SkipWhitespace();
-				if (cur.Pos() >= str.length())
-					return ParseResult::Ok{ buffer };
-
-				std::optional<Token> tk = ParseAt(cur);
-				if (!tk.has_value())
-					break;
-
-				cur.Seek(cur.Pos() + tk.value().view.length());
-				buffer.emplace_back(std::move(tk.value()));
-			};
-
-			return ParseResult::Err{
-				Format("Unknown token at char ", cur.Pos(), " \"", str.substr(cur.Pos(), 15), '"').str()
-			};
-		}
-	};
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <optional>
+#include <variant>
+#include <algorithm>
+#include "util.hpp"
+#include "parsestats.hpp"
+#include "stringcursor.hpp"
+#include "tokenbuffer.hpp"
+
+namespace Cdecl {
+	struct TokenDef {
+		enum class Kind {
+			Static,
+			Dynamic
+		};
+
+		struct Static {
+			enum Flag : uint32_t {
+				Keyword = 1 << 0,
+				CaseInsensitive = 1 << 1,
+			};
+
+			const tokenid_t id;
+			const std::basic_string<char_t> str;
+			const uint32_t flags = 0;
+
+			template <class ...T>
+			Static(tokenid_t id_, std::basic_string<char_t>&& str_, Flag flag, T... flags_)
+				: id(id_), str(str_), flags(CombineFlags(flag, flags_...)) {}
+			Static(tokenid_t id_, std::basic_string<char_t>&& str_) : id(id_), str(str_), flags(0) {}
+		};
+
+		struct Dynamic {
+			using callback_t = std::optional<Token>(StringCursor cursor);
+			callback_t* const callback;
+			Dynamic(callback_t* callback_) : callback(callback_) {}
+		};
+
+		const Kind kind;
+		const std::variant<Static, Dynamic> variant;
+
+		TokenDef(Static&& statik_) : kind(Kind::Static), variant(statik_) {}
+		TokenDef(Dynamic&& dynamic_) : kind(Kind::Dynamic), variant(dynamic_) {}
+
+		bool IsStatic() const { return std::holds_alternative<Static>(variant); }
+		bool IsDynamic() const { return std::holds_alternative<Dynamic>(variant); }
+
+		const Static& GetStatic() const { return std::get<Static>(variant); }
+		const Dynamic& GetDynamic() const { return std::get<Dynamic>(variant); }
+	};
+
+	inline std::string UnknownTokenError(const string_view& str, size_t pos) {
+		Stats::Count(&ParseStats::errors);
+		return Format("Unknown token at char ", pos, " \"", str.substr(pos, 15), '"').str();
+	}
+
+	/*
+	 * Tokenizes all of str, skipping whitespace between tokens, and hands each token to push.
+	 * parse_at has the same signature as Tokenizer::ParseAt.
+	 * Returns the position of the first unknown token, if any.
+	 */
+	template <class TParseAt, class TPush>
+	inline std::optional<size_t> TokenizeWith(const string_view& str, TParseAt parse_at, TPush push) {
+		Stats::PhaseTimer timer = Stats::PhaseTimer(ParseStats::Lex);
+		StringCursor cur = StringCursor(str);
+
+		while (true) {
+			cur.SkipWhitespace();
+			if (cur.Pos() >= str.length())
+				return {};
+
+			std::optional<Token> tk = parse_at(cur);
+			if (!tk.has_value())
+				break;
+
+			cur.Seek(cur.Pos() + tk.value().view.length());
+			Stats::Count(&ParseStats::tokens);
+			push(std::move(tk.value()));
+		};
+
+		return cur.Pos();
+	}
+
+	template <class TParseAt>
+	inline Result<std::vector<Token>, std::string> TokenizeAll(const string_view& str, TParseAt parse_at) {
+		using ParseResult = Result<std::vector<Token>, std::string>;
+
+		std::vector<Token> buffer;
+		std::optional<size_t> err = TokenizeWith(str, parse_at, [&](Token&& tk) { buffer.emplace_back(std::move(tk)); });
+		if (err.has_value())
+			return ParseResult::Err{ UnknownTokenError(str, err.value()) };
+		return ParseResult::Ok{ std::move(buffer) };
+	}
+
+	/*
+	 * Same as TokenizeAll, but fills a compact TokenBuffer.
+	 * Passing a buffer from an earlier parse reuses its storage.
+	 */
+	template <class TParseAt>
+	inline Result<TokenBuffer, std::string> TokenizeBuffer(const string_view& str, TParseAt parse_at, TokenBuffer&& buffer = TokenBuffer()) {
+		using ParseResult = Result<TokenBuffer, std::string>;
+
+		if (!TokenBuffer::FitsSource(str))
+			return ParseResult::Err{ Format("Input of ", str.length(), " chars is too large for a TokenBuffer").str() };
+
+		buffer.Reset(str);
+		std::optional<tokenid_t> bad_id;
+		std::optional<size_t> err = TokenizeWith(str, parse_at, [&](Token&& tk) {
+			if (TokenBuffer::FitsId(tk.id))
+				buffer.Push(tk.id, tk.view);
+			else if (!bad_id.has_value())
+				bad_id = tk.id;
+		});
+
+		if (err.has_value())
+			return ParseResult::Err{ UnknownTokenError(str, err.value()) };
+		if (bad_id.has_value())
+			return ParseResult::Err{ Format("Token id ", bad_id.value(), " is too large for a TokenBuffer").str() };
+		return ParseResult::Ok{ std::move(buffer) };
+	}
+
+	class Tokenizer {
+		/*
+		 * Byte trie of every static def.
+		 * Lets ParseAt find the longest static match in a single walk instead of testing each def.
+		 */
+		struct TrieNode {
+			std::vector<std::pair<char_t, uint32_t>> edges; // Sorted by character
+			std::optional<size_t> def_index;
+
+			std::optional<uint32_t> Next(char_t ch) const {
+				auto it = std::lower_bound(edges.begin(), edges.end(), ch,
+					[](const std::pair<char_t, uint32_t>& edge, char_t ch) { return edge.first < ch; });
+				if (it != edges.end() && it->first == ch)
+					return it->second;
+				return {};
+			}
+		};
+
+		struct Match {
+			size_t def_index;
+			size_t length;
+		};
+
+		std::vector<TokenDef> m_defs;
+		std::vector<size_t> m_dynamic;
+		std::vector<TrieNode> m_trie = { TrieNode() };
+		std::vector<TrieNode> m_trie_nocase = { TrieNode() }; // Stored lowercase
+
+		static void TrieInsert(std::vector<TrieNode>& trie, const string_view& str, size_t def_index, bool nocase) {
+			uint32_t node = 0;
+			for (char_t ch : str) {
+				if (nocase)
+					ch = AsciiLower(ch);
+
+				std::optional<uint32_t> next = trie[node].Next(ch);
+				if (!next.has_value()) {
+					next = (uint32_t)trie.size();
+					auto& edges = trie[node].edges;
+					auto it = std::lower_bound(edges.begin(), edges.end(), ch,
+						[](const std::pair<char_t, uint32_t>& edge, char_t ch) { return edge.first < ch; });
+					edges.emplace(it, ch, next.value());
+					trie.emplace_back();
+				}
+				node = next.value();
+			}
+
+			// The first def wins when two defs share a string
+			if (!trie[node].def_index.has_value())
+				trie[node].def_index = def_index;
+		}
+
+		std::optional<Match> TrieMatch(const std::vector<TrieNode>& trie, const string_view& str, bool nocase) const {
+			std::optional<Match> best;
+			uint32_t node = 0;
+
+			for (size_t i = 0; i < str.length(); ++i) {
+				std::optional<uint32_t> next = trie[node].Next(nocase ? AsciiLower(str[i]) : str[i]);
+				if (!next.has_value())
+					break;
+				node = next.value();
+
+				if (!trie[node].def_index.has_value())
+					continue;
+
+				size_t def_index = trie[node].def_index.value();
+				Stats::Count(&ParseStats::defs_tried);
+				const TokenDef::Static& statik = m_defs[def_index].GetStatic();
+				bool at_boundary = i + 1 >= str.length() || !IsIdentifierChar(str[i + 1]);
+				if (!(statik.flags & TokenDef::Static::Keyword) || at_boundary)
+					best = Match{ def_index, i + 1 };
+			}
+
+			return best;
+		}
+
+	public:
+		Tokenizer(std::vector<TokenDef>&& defs_) : m_defs(std::move(defs_)) {
+			for (size_t i = 0; i < m_defs.size(); ++i) {
+				if (m_defs[i].IsStatic()) {
+					const TokenDef::Static& statik = m_defs[i].GetStatic();
+					bool nocase = statik.flags & TokenDef::Static::CaseInsensitive;
+					if (!statik.str.empty())
+						TrieInsert(nocase ? m_trie_nocase : m_trie, statik.str, i, nocase);
+				}
+				else if (m_defs[i].IsDynamic())
+					m_dynamic.push_back(i);
+			}
+		}
+
+		using ParseResult = Result<std::vector<Token>, std::string>;
+
+		/*
+		 * Returns the longest token that any def matches at the cursor.
+		 * Ties go to whichever def was listed first.
+		 * Keyword defs only match when they end at an identifier boundary.
+		 */
+		std::optional<Token> ParseAt(StringCursor cursor) const {
+			const char_t* begin = cursor.Peek();
+			if (!begin)
+				return std::optional<Token>();
+
+			const string_view rest = cursor.Remaining();
+			std::optional<Match> best = TrieMatch(m_trie, rest, false);
+
+			if (std::optional<Match> nocase = TrieMatch(m_trie_nocase, rest, true)) {
+				if (!best.has_value() || nocase->length > best->length
+					|| (nocase->length == best->length && nocase->def_index < best->def_index))
+					best = nocase;
+			}
+
+			std::optional<Token> best_dynamic;
+			size_t best_dynamic_index = 0;
+			for (size_t def_index : m_dynamic) {
+				std::optional<Token> tk = m_defs[def_index].GetDynamic().callback(cursor);
+				Stats::Count(&ParseStats::defs_tried);
+				if (!tk.has_value() || tk->view.empty())
+					continue;
+
+				size_t best_length = best_dynamic.has_value() ? best_dynamic->view.length() : 0;
+				if (tk->view.length() > best_length) {
+					best_dynamic.emplace(tk->id, string_view(tk->view));
+					best_dynamic_index = def_index;
+				}
+			}
+
+			if (best_dynamic.has_value()) {
+				size_t length = best_dynamic->view.length();
+				if (!best.has_value() || length > best->length
+					|| (length == best->length && best_dynamic_index < best->def_index))
+					return best_dynamic;
+			}
+
+			if (best.has_value())
+				return Token(m_defs[best->def_index].GetStatic().id, string_view(begin, best->length));
+			return {};
+		}
+
+		ParseResult ParseAll(const string_view& str) const {
+			return TokenizeAll(str, [this](StringCursor cur) { return ParseAt(cur); });
+		}
+
+		using ParseBufferResult = Result<TokenBuffer, std::string>;
+		ParseBufferResult ParseBuffer(const string_view& str, TokenBuffer&& reuse = TokenBuffer()) const {
+			return TokenizeBuffer(str, [this](StringCursor cur) { return ParseAt(cur); }, std::move(reuse));
+		}
+	};
 }
\ No newline at end of file
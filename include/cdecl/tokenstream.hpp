@@ -0,0 +1,182 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <optional>
+#include "util.hpp"
+#include "tokenizer.hpp"
+
+namespace Cdecl {
+	/*
+	 * Pull-based tokenizer over input that arrives in chunks.
+	 * Only the text of the unread chunk and the tokens in the lookahead window are kept, so memory stays bounded.
+	 * A token that touches the end of the buffered text is held back until more input arrives or Finish() is called.
+	 *
+	 * TParseAt has the same signature as Tokenizer::ParseAt, e.g. Lexer::ParseAt or a lambda around a Tokenizer.
+	 * Views in returned tokens are valid until the next call to Feed().
+	 */
+	template <class TParseAt>
+	class TokenStream {
+	public:
+		enum class Status {
+			Ok,
+			NeedInput, // Feed() more text or Finish()
+			End,
+			Error,
+		};
+
+	private:
+		struct Entry {
+			tokenid_t id;
+			size_t offset; // Absolute char offset in the whole input
+			size_t length;
+		};
+
+		TParseAt m_parse_at;
+		std::basic_string<char_t> m_text;
+		size_t m_text_base = 0; // Absolute offset of m_text[0]
+		size_t m_scan = 0; // Absolute offset where lexing resumes
+		size_t m_max_token;
+		bool m_finished = false;
+		std::optional<std::string> m_err;
+
+		std::vector<Entry> m_ring;
+		size_t m_first = 0; // Absolute index of the oldest retained token
+		size_t m_count = 0;
+		size_t m_pos = 0; // Absolute index of the next token
+
+		Entry& At(size_t index) { return m_ring[index % m_ring.size()]; }
+		const Entry& At(size_t index) const { return m_ring[index % m_ring.size()]; }
+
+		Token MakeToken(const Entry& entry) const {
+			return Token(entry.id, string_view(m_text.data() + (entry.offset - m_text_base), entry.length));
+		}
+
+		// Lexes one more token into the ring. Returns false if none is available yet.
+		bool LexOne() {
+			if (m_err.has_value())
+				return false;
+
+			if (m_count == m_ring.size() && m_first >= m_pos)
+				return false; // The whole window is unread lookahead
+
+			string_view pending = string_view(m_text).substr(m_scan - m_text_base);
+			StringCursor cur = StringCursor(pending);
+			cur.SkipWhitespace();
+			m_scan += cur.Pos();
+
+			if (cur.Pos() >= pending.length())
+				return false;
+
+			std::optional<Token> tk = m_parse_at(cur);
+			bool at_end = tk.has_value() && cur.Pos() + tk->view.length() >= pending.length();
+
+			if (!tk.has_value() || (at_end && !m_finished)) {
+				if (m_finished || pending.length() - cur.Pos() > m_max_token)
+					m_err = Format("Unknown token at char ", m_scan, " \"", pending.substr(cur.Pos(), 15), '"').str();
+				return false;
+			}
+
+			if (m_count == m_ring.size())
+				++m_first, --m_count;
+
+			At(m_first + m_count) = Entry{ tk->id, m_scan, tk->view.length() };
+			++m_count;
+			m_scan += tk->view.length();
+			return true;
+		}
+
+		bool Fill(size_t lookahead) {
+			while (m_first + m_count <= m_pos + lookahead) {
+				if (!LexOne())
+					return false;
+			}
+			return true;
+		}
+
+	public:
+		/*
+		 * window: Max tokens retained for lookahead and Seek() backtracking.
+		 * max_token: Longest token that may be carried across chunks before an unknown token is reported.
+		 */
+		TokenStream(TParseAt parse_at, size_t window = 64, size_t max_token = 4096)
+			: m_parse_at(parse_at), m_max_token(max_token), m_ring(window ? window : 1) {}
+
+		void Feed(const string_view& chunk) {
+			// Drop text that no retained token refers to
+			size_t keep_from = m_count ? At(m_first).offset : m_scan;
+			m_text.erase(0, keep_from - m_text_base);
+			m_text_base = keep_from;
+			m_text.append(chunk.data(), chunk.length());
+		}
+
+		void Finish() { m_finished = true; }
+
+		Status GetStatus() {
+			if (Fill(0))
+				return Status::Ok;
+			if (m_err.has_value())
+				return Status::Error;
+			return m_finished ? Status::End : Status::NeedInput;
+		}
+
+		const std::optional<std::string>& GetErr() const { return m_err; }
+
+		size_t Pos() const { return m_pos; }
+
+		std::optional<Token> Peek(size_t offset = 0) {
+			if (!Fill(offset))
+				return {};
+			return MakeToken(At(m_pos + offset));
+		}
+
+		std::optional<Token> Skip() {
+			std::optional<Token> tk = Peek();
+			if (tk.has_value())
+				++m_pos;
+			return tk;
+		}
+
+		// Only positions still inside the window can be returned to
+		bool Seek(size_t pos) {
+			if (pos >= m_first && pos <= m_first + m_count) {
+				if (pos < m_pos)
+					Stats::Count(&ParseStats::backtracks);
+				m_pos = pos;
+				return true;
+			}
+			return false;
+		}
+
+		std::optional<Token> Match(tokenid_t id) {
+			std::optional<Token> tk = Peek();
+			if (tk.has_value() && tk->id == id) {
+				++m_pos;
+				return tk;
+			}
+			return {};
+		}
+
+		template <class TId, class ...TMore>
+		std::optional<Token> MatchAny(TId id, TMore... more) {
+			std::optional<Token> tk = Match((tokenid_t)id);
+			if constexpr (sizeof...(more) > 0)
+				return tk.has_value() ? tk : MatchAny(more...);
+			else
+				return tk;
+		}
+
+		bool MatchSequence() {
+			return true;
+		}
+
+		template <class TId, class ...TMore>
+		bool MatchSequence(TId id, TMore... more) {
+			size_t begin = Pos();
+			bool result = Match((tokenid_t)id).has_value() && MatchSequence(more...);
+			if (!result)
+				Seek(begin);
+			return result;
+		}
+	};
+}
\ No newline at end of file
@@ -1,63 +1,79 @@
-#pragma once
-#include "config.hpp"
-#include <variant>
-#include <string_view>
-#include <sstream>
-
-namespace Cdecl {
-	using string_view = std::basic_string_view<char_t>;
-	using stringstream = std::basic_stringstream<char_t>;
-	using string_view = std::basic_string_view<char_t>;
-	using string = std::basic_string<char_t>;
-
-	template <class TOk, class TErr>
-	class Result {
-	public:
-		struct Ok {
-			TOk value;
-		};
-		struct Err {
-			TErr value;
-		};
-
-	private:
-		std::variant<Ok, Err> m_variant;
-
-	public:
-		Result(Ok&& ok) : m_variant(ok) {}
-		Result(Err&& err) : m_variant(err) {}
-
-		operator bool() const { return IsOk(); }
-
-		bool IsOk() const { return std::holds_alternative<Ok>(m_variant); }
-		bool IsErr() const { return !IsOk(); }
-
-		const TOk& GetOk() const { return std::get<Ok>(m_variant).value; }
-		const TErr& GetErr() const { return std::get<Err>(m_variant).value; }
-	};
-
-	inline uint32_t CombineFlags(uint32_t start_flag) { return start_flag; }
-
-	template <class TInt, class TFlag, class ...T>
-	inline TInt CombineFlags(TInt start_flag, TFlag next_flag, T... more) {
-		return CombineFlags(start_flag | (TInt)next_flag, more...);
-	}
-
-	template <class TInt, class TFlag, class ...T>
-	inline TInt CombineFlags(TFlag next_flag, T... more) {
-		return CombineFlags(0, (TInt)next_flag, more...);
-	}
-
-	inline stringstream Format(stringstream&& ss) { return std::move(ss); }
-
-	template <class T, class ...TMore>
-	inline stringstream Format(stringstream&& ss, T item, TMore... more) {
-		ss << item;
-		return Format(std::move(ss), more...);
-	}
-
-	template <class T, class ...TMore>
-	inline stringstream Format(T item, TMore... more) {
-		return Format(stringstream(), item, more...);
-	}
+#pragma once
+#include "config.hpp"
+#include <cstdint>
+#include <variant>
+#include <string_view>
+#include <sstream>
+
+namespace Cdecl {
+	using string_view = std::basic_string_view<char_t>;
+	using stringstream = std::basic_stringstream<char_t>;
+	using string_view = std::basic_string_view<char_t>;
+	using string = std::basic_string<char_t>;
+
+	template <class TOk, class TErr>
+	class Result {
+	public:
+		struct Ok {
+			TOk value;
+		};
+		struct Err {
+			TErr value;
+		};
+
+	private:
+		std::variant<Ok, Err> m_variant;
+
+	public:
+		Result(Ok&& ok) : m_variant(std::move(ok)) {}
+		Result(Err&& err) : m_variant(std::move(err)) {}
+
+		operator bool() const { return IsOk(); }
+
+		bool IsOk() const { return std::holds_alternative<Ok>(m_variant); }
+		bool IsErr() const { return !IsOk(); }
+
+		const TOk& GetOk() const { return std::get<Ok>(m_variant).value; }
+		const TErr& GetErr() const { return std::get<Err>(m_variant).value; }
+
+		// Moves the value out, e.g. to hand a TokenBuffer's storage to the next parse
+		TOk TakeOk() { return std::move(std::get<Ok>(m_variant).value); }
+	};
+
+	inline bool IsIdentifierChar(char_t ch) {
+		return ch == '_' || (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9');
+	}
+
+	inline char_t AsciiLower(char_t ch) {
+		return ch >= 'A' && ch <= 'Z' ? (char_t)(ch - 'A' + 'a') : ch;
+	}
+
+	inline size_t HashCombine(size_t seed, size_t value) {
+		return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+	}
+
+	inline uint32_t CombineFlags(uint32_t start_flag) { return start_flag; }
+
+	template <class TInt, class TFlag, class ...T>
+	inline TInt CombineFlags(TInt start_flag, TFlag next_flag, T... more) {
+		return CombineFlags(start_flag | (TInt)next_flag, more...);
+	}
+
+	template <class TInt, class TFlag, class ...T>
+	inline TInt CombineFlags(TFlag next_flag, T... more) {
+		return CombineFlags(0, (TInt)next_flag, more...);
+	}
+
+	inline stringstream Format(stringstream&& ss) { return std::move(ss); }
+
+	template <class T, class ...TMore>
+	inline stringstream Format(stringstream&& ss, T item, TMore... more) {
+		ss << item;
+		return Format(std::move(ss), more...);
+	}
+
+	template <class T, class ...TMore>
+	inline stringstream Format(T item, TMore... more) {
+		return Format(stringstream(), item, more...);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include <cdecl/c/batch.hpp>
+#include <cdecl/c/lexer.hpp>
+#include <cdecl/parallel.hpp>
+#include <atomic>
+#include <memory>
+
+namespace Cdecl {
+	/*
+	 * Each worker owns a contiguous range of chunks and claims them from the front with an atomic counter.
+	 * A thief claims from the same counter, so every chunk is taken exactly once without any locks.
+	 */
+	struct alignas(64) ChunkRange {
+		std::atomic<size_t> next;
+		size_t end;
+	};
+
+	static BatchResult ParseOne(const string_view& decl, const ParseContext& ctx) {
+		Lexer::ParseBufferResult lexed = Lexer::ParseBuffer(decl);
+		if (!lexed)
+			return BatchResult::Err{ lexed.GetErr() };
+		const TokenBuffer& tokens = lexed.GetOk();
+
+		auto result = FunctionProto::Parse(TokenCursor(tokens), ctx);
+		if (!result)
+			return BatchResult::Err{ result.GetErr().Render(tokens) };
+
+		// Anything after the prototype, like a second declaration, would otherwise be dropped silently
+		size_t end = std::get<TokenCursor>(result.GetOk()).Pos();
+		if (end != tokens.Size())
+			return BatchResult::Err{ ParseError(ErrorCode::TrailingTokens, end).Render(tokens) };
+		return BatchResult::Ok{ std::get<FunctionProto>(result.GetOk()) };
+	}
+
+	std::vector<BatchResult> ParseBatch(const string_view* decls, size_t count, const ParseContext& ctx, size_t threads, size_t chunk_size) {
+		if (!chunk_size)
+			chunk_size = 1;
+
+		size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+		size_t worker_count = std::min(Parallel::ResolveThreads(threads), chunk_count);
+
+		// Arenas are single-threaded, so each worker allocates from its own child of the caller's
+		std::vector<ParseContext> worker_ctx(worker_count, ctx);
+		if (ctx.arena) {
+			for (size_t i = 0; i < worker_count; ++i)
+				worker_ctx[i].arena = &ctx.arena->Child(i);
+		}
+
+		std::vector<std::optional<BatchResult>> slots(count);
+		std::unique_ptr<ChunkRange[]> ranges = std::unique_ptr<ChunkRange[]>(new ChunkRange[worker_count]);
+		for (size_t i = 0; i < worker_count; ++i) {
+			ranges[i].next = chunk_count * i / worker_count;
+			ranges[i].end = chunk_count * (i + 1) / worker_count;
+		}
+
+		auto run_chunk = [&](size_t chunk, const ParseContext& chunk_ctx) {
+			size_t end = std::min(count, (chunk + 1) * chunk_size);
+			for (size_t i = chunk * chunk_size; i < end; ++i)
+				slots[i].emplace(ParseOne(decls[i], chunk_ctx));
+		};
+
+		Parallel::RunChunks(worker_count, [&](size_t worker) {
+			// Drain our own range first, then visit the others in turn
+			for (size_t offset = 0; offset < worker_count; ++offset) {
+				ChunkRange& range = ranges[(worker + offset) % worker_count];
+				for (size_t chunk = range.next++; chunk < range.end; chunk = range.next++)
+					run_chunk(chunk, worker_ctx[worker]);
+			}
+		});
+
+		std::vector<BatchResult> results;
+		results.reserve(count);
+		for (std::optional<BatchResult>& slot : slots)
+			results.push_back(std::move(slot.value()));
+		return results;
+	}
+}
\ No newline at end of file
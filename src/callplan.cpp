@@ -0,0 +1,261 @@
+#include <cdecl/c/callplan.hpp>
+#include <array>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#define CDECL_HOST_SYSV_X64
+#endif
+
+namespace Cdecl {
+	/*
+	 * Argument passing rules as data. Integer and vector registers are handed out independently, left to right.
+	 * Anything that doesn't get a register goes on the stack in order.
+	 */
+	struct ConventionRules {
+		uint8_t int_regs;
+		uint8_t vec_regs;
+		uint8_t slot_size;
+		uint8_t max_int_reg_size; // Wider integers always go on the stack
+		bool first_arg_only; // Only the first argument may use an integer register, like `this` in thiscall
+		bool callee_cleans;
+	};
+
+	static constexpr ConventionRules sysv_x64_rules = { 6, 8, 8, 8, false, false }; // rdi, rsi, rdx, rcx, r8, r9 and xmm0-7
+
+	// Indexed by CallConvention
+	static constexpr ConventionRules win32_rules[] = {
+		{ 0, 0, 4, 4, false, false }, // cdecl
+		{ 0, 0, 4, 4, false, true }, // stdcall
+		{ 2, 0, 4, 4, false, true }, // fastcall: ecx, edx
+		{ 1, 0, 4, 4, true, true }, // thiscall: ecx
+		{ 2, 6, 4, 4, false, true }, // vectorcall: ecx, edx and xmm0-5
+	};
+
+	static constexpr uint32_t load_sizes[] = { 1, 1, 2, 2, 4, 4, 8, 4, 8 };
+
+	static constexpr size_t invoke_int_regs = 6;
+	static constexpr size_t invoke_vec_regs = 8;
+	static constexpr size_t invoke_max_stack = 16;
+
+	static bool IsFloatLoad(CallPlan::Load load) { return load == CallPlan::Load::F32 || load == CallPlan::Load::F64; }
+
+	static std::optional<CallPlan::Load> Classify(const Type& type, Abi abi) {
+		using Load = CallPlan::Load;
+
+		if (type.IsPointer())
+			return abi == Abi::Win32 ? Load::U32 : Load::I64;
+		if (!type.IsPrimitive())
+			return {};
+
+		switch (type.GetPrimitiveType()) {
+		case Type::Primitive::Int8_t: return Load::I8;
+		case Type::Primitive::Uint8_t: return Load::U8;
+		case Type::Primitive::Int16_t: return Load::I16;
+		case Type::Primitive::Uint16_t: return Load::U16;
+		case Type::Primitive::Int32_t: return Load::I32;
+		case Type::Primitive::Uint32_t: return Load::U32;
+		case Type::Primitive::Int64_t:
+		case Type::Primitive::Uint64_t: return Load::I64;
+		case Type::Primitive::Char: return type.IsUnsigned() ? Load::U8 : Load::I8;
+		case Type::Primitive::Enum: return Load::I32;
+		case Type::Primitive::Float: return Load::F32;
+		case Type::Primitive::Double:
+			if (type.IsLong() && abi == Abi::SysV_x64)
+				return {}; // x87 long double
+			return Load::F64;
+		case Type::Primitive::Int: {
+			std::optional<TypeLayout> layout = GetTypeLayout(type, abi);
+			if (layout->size == 2)
+				return type.IsUnsigned() ? Load::U16 : Load::I16;
+			if (layout->size == 4)
+				return type.IsUnsigned() ? Load::U32 : Load::I32;
+			return Load::I64;
+		}
+		default:
+			return {};
+		}
+	}
+
+	// The default argument promotions applied to arguments passed in place of `...`
+	static CallPlan::Load Promote(CallPlan::Load load) {
+		switch (load) {
+		case CallPlan::Load::I8:
+		case CallPlan::Load::U8:
+		case CallPlan::Load::I16:
+		case CallPlan::Load::U16: return CallPlan::Load::I32; // int holds every value of the narrower types
+		case CallPlan::Load::F32: return CallPlan::Load::F64;
+		default: return load;
+		}
+	}
+
+	static const std::shared_ptr<const Type>& GetArgType(const Argument& arg) {
+		return arg.IsVariable() ? arg.GetVar().GetType() : arg.GetType();
+	}
+
+	CompileCallPlanResult CompileCallPlan(
+		const FunctionProto& proto, Abi abi, const std::vector<std::shared_ptr<const Type>>& variadic_args
+	) {
+		CallPlan plan = {};
+		plan.abi = abi;
+		plan.conv = proto.GetConventionOrDefault(CallConvention::Cdecl);
+
+		ConventionRules rules;
+		if (abi == Abi::SysV_x64)
+			rules = sysv_x64_rules;
+		else if (abi == Abi::Win32)
+			rules = win32_rules[(size_t)plan.conv];
+		else
+			return CompileCallPlanResult::Err{ "Call plans are not implemented for Win64 yet" };
+		plan.callee_cleans = rules.callee_cleans;
+
+		std::vector<std::shared_ptr<const Type>> types;
+		bool variadic = false;
+		for (const Argument& arg : proto.GetArgs()) {
+			if (arg.IsVariadic())
+				variadic = true;
+			else
+				types.push_back(GetArgType(arg));
+		}
+		if (!variadic && !variadic_args.empty())
+			return CompileCallPlanResult::Err{ "Variadic arguments given for a function that isn't variadic" };
+		size_t fixed_count = types.size();
+		types.insert(types.end(), variadic_args.begin(), variadic_args.end());
+
+		// `(void)` may also come through as a single void argument
+		if (types.size() == 1 && types[0]->IsPrimitive() && !types[0]->IsPointer() && types[0]->GetPrimitiveType() == Type::Primitive::Void)
+			types.clear();
+
+		uint32_t offset = 0;
+		for (size_t i = 0; i < types.size(); ++i) {
+			std::optional<CallPlan::Load> load = Classify(*types[i], abi);
+			if (!load.has_value())
+				return CompileCallPlanResult::Err{ Format("Argument ", i, " can't be passed by this call plan (structs and long double are unsupported)").str() };
+			if (i >= fixed_count)
+				load = Promote(load.value());
+
+			uint32_t size = load_sizes[(size_t)load.value()];
+			offset = (offset + size - 1) / size * size;
+			plan.arg_offsets.push_back(offset);
+
+			CallPlan::Step step = CallPlan::Step{ load.value(), CallPlan::Dest::Stack, 0, offset };
+			offset += size;
+
+			bool may_use_int = !rules.first_arg_only || i == 0;
+			if (IsFloatLoad(step.load) && plan.vec_regs_used < rules.vec_regs) {
+				step.dest = CallPlan::Dest::VecReg;
+				step.index = plan.vec_regs_used++;
+			}
+			else if (!IsFloatLoad(step.load) && may_use_int && plan.int_regs_used < rules.int_regs && size <= rules.max_int_reg_size) {
+				step.dest = CallPlan::Dest::IntReg;
+				step.index = plan.int_regs_used++;
+			}
+			else {
+				step.index = (uint16_t)plan.stack_slots;
+				plan.stack_slots += (size + rules.slot_size - 1) / rules.slot_size;
+			}
+			plan.steps.push_back(step);
+		}
+		plan.args_size = offset;
+
+		const Type& ret_type = *proto.GetReturnType();
+		if (ret_type.IsPrimitive() && !ret_type.IsPointer() && ret_type.GetPrimitiveType() == Type::Primitive::Void)
+			plan.ret = CallPlan::Return::Void;
+		else if (std::optional<CallPlan::Load> load = Classify(ret_type, abi)) {
+			plan.ret = IsFloatLoad(load.value()) ? CallPlan::Return::Float : CallPlan::Return::Int;
+			plan.ret_load = load.value();
+			plan.ret_size = load_sizes[(size_t)load.value()];
+		}
+		else
+			return CompileCallPlanResult::Err{ "Return type can't be returned by this call plan (structs and long double are unsupported)" };
+
+		return CompileCallPlanResult::Ok{ std::move(plan) };
+	}
+
+	bool CanInvoke(const CallPlan& plan) {
+#ifdef CDECL_HOST_SYSV_X64
+		return plan.abi == Abi::SysV_x64 && plan.stack_slots <= invoke_max_stack;
+#else
+		return false;
+#endif
+	}
+
+#ifdef CDECL_HOST_SYSV_X64
+	/*
+	 * Every call goes through one signature that fills all six integer and eight vector registers,
+	 * with stack slots passed as trailing variadic words. The variadic tail also sets %al, which variadic callees need.
+	 */
+	template <class TRet, size_t ...I>
+	static TRet CallSysV(void (*fn)(), const uint64_t* i, const double* v, const uint64_t* s) {
+		using Fn = TRet(*)(uint64_t, uint64_t, uint64_t, uint64_t, uint64_t, uint64_t, double, double, double, double, double, double, double, double, ...);
+		return ((Fn)fn)(i[0], i[1], i[2], i[3], i[4], i[5], v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], s[I]...);
+	}
+
+	template <class TRet>
+	using SysVCaller = TRet(*)(void (*)(), const uint64_t*, const double*, const uint64_t*);
+
+	template <class TRet, size_t ...I>
+	static constexpr SysVCaller<TRet> GetSysVCaller(std::index_sequence<I...>) {
+		return &CallSysV<TRet, I...>;
+	}
+
+	// Element N passes N stack slots
+	template <class TRet, size_t ...N>
+	static constexpr std::array<SysVCaller<TRet>, sizeof...(N)> MakeSysVCallers(std::index_sequence<N...>) {
+		return { GetSysVCaller<TRet>(std::make_index_sequence<N>())... };
+	}
+#endif
+
+	static uint64_t LoadArg(CallPlan::Load load, const unsigned char* src) {
+		switch (load) {
+		case CallPlan::Load::I8: { int8_t v; std::memcpy(&v, src, 1); return (uint64_t)(int64_t)v; }
+		case CallPlan::Load::U8: { uint8_t v; std::memcpy(&v, src, 1); return v; }
+		case CallPlan::Load::I16: { int16_t v; std::memcpy(&v, src, 2); return (uint64_t)(int64_t)v; }
+		case CallPlan::Load::U16: { uint16_t v; std::memcpy(&v, src, 2); return v; }
+		case CallPlan::Load::I32: { int32_t v; std::memcpy(&v, src, 4); return (uint64_t)(int64_t)v; }
+		case CallPlan::Load::U32:
+		case CallPlan::Load::F32: { uint32_t v; std::memcpy(&v, src, 4); return v; }
+		default: { uint64_t v; std::memcpy(&v, src, 8); return v; }
+		}
+	}
+
+	bool Invoke(const CallPlan& plan, void (*fn)(), const void* args, void* ret) {
+		if (!CanInvoke(plan))
+			return false;
+
+#ifdef CDECL_HOST_SYSV_X64
+		uint64_t ints[invoke_int_regs] = {};
+		double vecs[invoke_vec_regs] = {};
+		uint64_t stack[invoke_max_stack] = {};
+
+		const unsigned char* base = (const unsigned char*)args;
+		for (const CallPlan::Step& step : plan.steps) {
+			uint64_t value = LoadArg(step.load, base + step.src);
+			switch (step.dest) {
+			case CallPlan::Dest::IntReg: ints[step.index] = value; break;
+			case CallPlan::Dest::VecReg: std::memcpy(&vecs[step.index], &value, sizeof(value)); break;
+			case CallPlan::Dest::Stack: stack[step.index] = value; break;
+			}
+		}
+
+		// One caller per stack slot count, so only the slots in use are pushed
+		static constexpr std::array<SysVCaller<uint64_t>, invoke_max_stack + 1> int_callers =
+			MakeSysVCallers<uint64_t>(std::make_index_sequence<invoke_max_stack + 1>());
+		static constexpr std::array<SysVCaller<double>, invoke_max_stack + 1> float_callers =
+			MakeSysVCallers<double>(std::make_index_sequence<invoke_max_stack + 1>());
+
+		if (plan.ret == CallPlan::Return::Float) {
+			double value = float_callers[plan.stack_slots](fn, ints, vecs, stack);
+			std::memcpy(ret, &value, plan.ret_size); // A float is the low 4 bytes of xmm0
+		}
+		else {
+			uint64_t value = int_callers[plan.stack_slots](fn, ints, vecs, stack);
+			if (plan.ret == CallPlan::Return::Int)
+				std::memcpy(ret, &value, plan.ret_size);
+		}
+		return true;
+#else
+		return false;
+#endif
+	}
+}
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include <cdecl/c/emit.hpp>
+#include <cdecl/c/tokendefs.hpp>
+#include <array>
+
+namespace Cdecl {
+	namespace EmitTables {
+		constexpr std::array<std::string_view, TokenId::Identifier> MakeSpellings() {
+			std::array<std::string_view, TokenId::Identifier> spellings = {};
+			for (const TokenSpelling& kw : keyword_spellings)
+				spellings[kw.id] = kw.str;
+			for (const TokenSpelling& punct : punctuator_spellings)
+				spellings[punct.id] = punct.str;
+			return spellings;
+		}
+
+		constexpr std::array<std::string_view, TokenId::Identifier> spellings = MakeSpellings();
+
+		// Indexed by Type::Primitive
+		constexpr tokenid_t primitive_tokens[] = {
+			TokenId::Int8_t, TokenId::Int16_t, TokenId::Int32_t, TokenId::Int64_t,
+			TokenId::Uint8_t, TokenId::Uint16_t, TokenId::Uint32_t, TokenId::Uint64_t,
+			TokenId::Char, TokenId::Enum, TokenId::Float, TokenId::Double, TokenId::Int,
+			TokenId::Struct, TokenId::Union, TokenId::Void,
+		};
+
+		// Indexed by CallConvention
+		constexpr tokenid_t call_conv_tokens[] = {
+			TokenId::Cdecl, TokenId::Stdcall, TokenId::Fastcall, TokenId::Thiscall, TokenId::Vectorcall,
+		};
+	}
+
+	static void Append(string& out, std::string_view text) {
+		out.append(text.begin(), text.end());
+	}
+
+	// Appends space-separated words, starting without a space
+	struct WordWriter {
+		string& out;
+		bool space = false;
+
+		void Word(tokenid_t id) {
+			if (space)
+				out += ' ';
+			Append(out, EmitTables::spellings[id]);
+			space = true;
+		}
+	};
+
+	// A node that only wraps another Type, i.e. a pointer level
+	static bool IsWrapper(const Type& type) {
+		return !type.IsPrimitive() && !type.IsFunctionProto() && !type.IsRecord();
+	}
+
+	// Qualifiers that follow a '*', each with a leading space
+	static void EmitPointerQualifiers(const Type& type, string& out) {
+		if (type.IsConst())
+			Append(out, " const");
+		if (type.IsVolatile())
+			Append(out, " volatile");
+		if (type.HasCallConvention()) {
+			out += ' ';
+			Append(out, EmitTables::spellings[EmitTables::call_conv_tokens[(size_t)type.GetConvention()]]);
+		}
+	}
+
+	// `struct Tag`, or just `struct` if anonymous
+	static void EmitRecordTag(const Record& record, string& out) {
+		WordWriter words = WordWriter{ out };
+		words.Word(record.IsUnion() ? TokenId::Union : TokenId::Struct);
+		if (!record.GetTag().empty())
+			out += ' ', out.append(record.GetTag());
+	}
+
+	static void EmitBase(const Type& type, string& out) {
+		WordWriter words = WordWriter{ out };
+		if (type.IsConst())
+			words.Word(TokenId::Const);
+		if (type.IsVolatile())
+			words.Word(TokenId::Volatile);
+
+		if (type.IsRecord()) {
+			if (words.space)
+				out += ' ';
+
+			// Tagged records are defined once by EmitRecord and referred to by tag, like in C
+			const Record& record = *type.GetRecord();
+			if (record.GetTag().empty())
+				EmitRecord(record, out);
+			else
+				EmitRecordTag(record, out);
+			words.space = true;
+		}
+		else {
+			if (type.IsSigned())
+				words.Word(TokenId::Signed);
+			if (type.IsUnsigned())
+				words.Word(TokenId::Unsigned);
+			if (type.IsShort())
+				words.Word(TokenId::Short);
+			if (type.IsLong())
+				words.Word(TokenId::Long);
+			if (type.IsLongLong())
+				words.Word(TokenId::Long), words.Word(TokenId::Long);
+
+			// `unsigned long` rather than `unsigned long int`
+			Type::Primitive prim = type.GetPrimitiveType();
+			bool sized = type.IsShort() || type.IsLong() || type.IsLongLong();
+			if (prim != Type::Primitive::Int || !sized)
+				words.Word(EmitTables::primitive_tokens[(size_t)prim]);
+		}
+
+		if (type.HasCallConvention())
+			words.Word(EmitTables::call_conv_tokens[(size_t)type.GetConvention()]);
+		if (type.IsPointer())
+			out += '*';
+	}
+
+	// Innermost level first, so the level closest to the name comes last, as in C
+	static void EmitPointers(const Type& type, const Type& base, string& out) {
+		if (&type == &base)
+			return;
+		EmitPointers(*type.GetPointedType(), base, out);
+		if (type.IsPointer())
+			out += '*';
+		EmitPointerQualifiers(type, out);
+	}
+
+	static void EmitArgs(const ArenaVector<Argument>& args, string& out) {
+		out += '(';
+		for (size_t i = 0; i < args.size(); ++i) {
+			if (i)
+				Append(out, ", ");
+
+			const Argument& arg = args[i];
+			if (arg.IsVariadic())
+				Append(out, "...");
+			else if (arg.IsType())
+				EmitDecl(*arg.GetType(), string_view(), out);
+			else
+				EmitVariable(arg.GetVar(), out);
+		}
+		out += ')';
+	}
+
+	void EmitDecl(const Type& type, string_view name, string& out) {
+		const Type* base = &type;
+		while (IsWrapper(*base))
+			base = base->GetPointedType().get();
+
+		// Function types wrap their pointer levels and name in parentheses: `int (* const f)(int)`
+		if (base->IsFunctionProto()) {
+			const FunctionProto& proto = *base->GetFunctionProto();
+			EmitDecl(*proto.GetReturnType(), string_view(), out);
+			Append(out, " (");
+			EmitPointers(type, *base, out);
+			if (!name.empty())
+				out += ' ', out.append(name);
+			out += ')';
+			EmitArgs(proto.GetArgs(), out);
+			return;
+		}
+
+		EmitBase(*base, out);
+		EmitPointers(type, *base, out);
+		if (!name.empty())
+			out += ' ', out.append(name);
+	}
+
+	void EmitType(const Type& type, string& out) {
+		EmitDecl(type, string_view(), out);
+	}
+
+	void EmitVariable(const Variable& var, string& out) {
+		EmitDecl(*var.GetType(), var.GetName(), out);
+	}
+
+	void EmitFunctionProto(const FunctionProto& proto, string& out) {
+		EmitDecl(*proto.GetReturnType(), proto.GetName(), out);
+		EmitArgs(proto.GetArgs(), out);
+	}
+
+	void EmitRecord(const Record& record, string& out) {
+		EmitRecordTag(record, out);
+		if (!record.IsComplete())
+			return;
+
+		Append(out, " {");
+		for (const Variable& member : record.GetMembers()) {
+			out += ' ';
+			EmitVariable(member, out);
+			out += ';';
+		}
+		Append(out, " }");
+	}
+
+	void EmitFunctionProtos(const FunctionProto* protos, size_t count, string& out, string_view terminator) {
+		// Typical prototypes are a few dozen chars. Growing past this is geometric anyway.
+		out.reserve(out.size() + count * (64 + terminator.length()));
+
+		for (size_t i = 0; i < count; ++i) {
+			EmitFunctionProto(protos[i], out);
+			out.append(terminator);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include <cdecl/c/error.hpp>
+#include <cdecl/tokencursor.hpp>
+
+namespace Cdecl {
+	const char* GetErrorMessage(ErrorCode code) {
+		switch (code) {
+		case ErrorCode::UnhandledToken: return "Unhandled token id ";
+		case ErrorCode::InvalidLong: return "Invalid combination of 'long' specifiers";
+		case ErrorCode::LongAndShort: return "Cannot specify 'long' and 'short' together";
+		case ErrorCode::MultipleCallConventions: return "Cannot specify multiple calling conventions";
+		case ErrorCode::InvalidSpecifiers: return "Invalid combination of type specifiers";
+		case ErrorCode::IntSpecifiersOnNonInt: return "Cannot use integer-only type specifiers on a non-integer";
+		case ErrorCode::IntSpecifiersOnPointer: return "Cannot use integer-only type specifiers on a pointer";
+		case ErrorCode::ExpectedPrimitive: return "Expected a primitive numerical type or void";
+		case ErrorCode::ExpectedIdentifier: return "Expected an identifier";
+		case ErrorCode::ExpectedArguments: return "Expected function arguments in parentheses";
+		case ErrorCode::ExpectedTypedef: return "Expected a typedef declaration";
+		case ErrorCode::TypedefRedefinition: return "Typedef redefined with a different type";
+		case ErrorCode::ExpectedRecordBody: return "Expected a struct or union tag or member list";
+		case ErrorCode::ExpectedSemicolon: return "Expected ';' after a member";
+		case ErrorCode::TagRedefinition: return "Struct or union tag redefined differently";
+		case ErrorCode::TrailingTokens: return "Unexpected tokens after the declaration";
+		default: return "Unknown error";
+		}
+	}
+
+	static std::string_view GetTokenSpelling(tokenid_t id) {
+		for (const TokenSpelling& kw : keyword_spellings) {
+			if (kw.id == id)
+				return kw.str;
+		}
+		for (const TokenSpelling& punct : punctuator_spellings) {
+			if (punct.id == id)
+				return punct.str;
+		}
+		return "identifier";
+	}
+
+	string ParseError::Render(const TokenBuffer& tokens) const {
+		stringstream ss = TokenCursor(tokens).FormatWithLoc(pos, GetErrorMessage(code));
+		if (code == ErrorCode::UnhandledToken)
+			ss << detail;
+
+		if (!expected.Empty()) {
+			ss << " (expected";
+			const char* sep = " ";
+			for (tokenid_t id = 0; id < 64; ++id) {
+				if (!expected.Contains(id))
+					continue;
+				ss << sep << '\'' << GetTokenSpelling(id).data() << '\'';
+				sep = ", ";
+			}
+			ss << ')';
+		}
+		return ss.str();
+	}
+}
\ No newline at end of file
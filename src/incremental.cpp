@@ -0,0 +1,107 @@
+#include <cdecl/c/incremental.hpp>
+#include <cdecl/c/declsplit.hpp>
+#include <cdecl/c/lexer.hpp>
+#include <cdecl/arena.hpp>
+#include <cdecl/parsestats.hpp>
+#include <algorithm>
+
+namespace Cdecl {
+	// A declaration's nodes, argument list and names, kept alive by its result
+	struct DeclStorage {
+		Arena arena = Arena(1024);
+		std::optional<FunctionProto> proto;
+	};
+
+	IncrementalParser::IncrementalParser(string text, const ParseContext& ctx) : m_text(std::move(text)), m_ctx(ctx) {
+		Edit(0, 0, string_view());
+	}
+
+	IncrementalParser::Decl IncrementalParser::MakeDecl(const string_view& decl, size_t end) const {
+		size_t begin = decl.data() - m_text.data();
+
+		Lexer::ParseBufferResult lexed = Lexer::ParseBuffer(decl);
+		if (!lexed)
+			return Decl{ begin, decl.length(), end, TokenBuffer(decl), DeclResult::Err{ lexed.GetErr() } };
+		const TokenBuffer& tokens = lexed.GetOk();
+
+		Stats::Count(&ParseStats::allocations);
+		std::shared_ptr<DeclStorage> storage = std::make_shared<DeclStorage>();
+		ParseContext ctx = m_ctx;
+		ctx.arena = &storage->arena;
+
+		auto result = FunctionProto::Parse(TokenCursor(tokens), ctx);
+		if (!result)
+			return Decl{ begin, decl.length(), end, tokens, DeclResult::Err{ result.GetErr().Render(tokens) } };
+
+		// Anything after the prototype, like a second declaration missing its ';', would otherwise be dropped silently
+		size_t tokens_end = std::get<TokenCursor>(result.GetOk()).Pos();
+		if (tokens_end != tokens.Size())
+			return Decl{ begin, decl.length(), end, tokens, DeclResult::Err{ ParseError(ErrorCode::TrailingTokens, tokens_end).Render(tokens) } };
+
+		storage->proto.emplace(std::get<FunctionProto>(result.GetOk()));
+		std::shared_ptr<const FunctionProto> proto = std::shared_ptr<const FunctionProto>(storage, &storage->proto.value());
+		return Decl{ begin, decl.length(), end, tokens, DeclResult::Ok{ std::move(proto) } };
+	}
+
+	IncrementalParser::EditResult IncrementalParser::Edit(size_t offset, size_t removed, const string_view& inserted) {
+		offset = std::min(offset, m_text.length());
+		removed = std::min(removed, m_text.length() - offset);
+		const size_t damage_end = offset + removed; // In the old text
+
+		const char_t* old_data = m_text.data();
+		m_text.replace(offset, removed, inserted.data(), inserted.length());
+
+		auto end_before = [](const Decl& decl, size_t pos) { return decl.end < pos; };
+
+		// The first declaration the edit may touch. One ending exactly at the edit is included,
+		// since text inserted there can extend it when it ended at a directive or the end of the buffer.
+		size_t first = std::lower_bound(m_decls.begin(), m_decls.end(), offset, end_before) - m_decls.begin();
+		size_t start = first ? m_decls[first - 1].end : 0;
+
+		// Old declarations ending at or after the damage are followed by unchanged text, so they can resync the split
+		size_t old = std::lower_bound(m_decls.begin() + first, m_decls.end(), damage_end, end_before) - m_decls.begin();
+		size_t resume = m_decls.size();
+
+		std::vector<Decl> fresh;
+		DeclSplitter splitter = DeclSplitter(m_text, start);
+		while (true) {
+			std::optional<string_view> decl = splitter.Next();
+			if (!decl.has_value())
+				break;
+
+			size_t pos = splitter.Pos();
+			fresh.push_back(MakeDecl(decl.value(), pos));
+
+			while (old < m_decls.size() && m_decls[old].end - removed + inserted.length() < pos)
+				++old;
+			if (old < m_decls.size() && m_decls[old].end - removed + inserted.length() == pos) {
+				resume = old + 1;
+				break;
+			}
+		}
+
+		EditResult edit = EditResult{ first, resume - first, fresh.size() };
+
+		// Overwrite in place where the counts overlap, so a typical edit doesn't shift the whole vector
+		size_t overlap = std::min(fresh.size(), resume - first);
+		std::move(fresh.begin(), fresh.begin() + overlap, m_decls.begin() + first);
+		if (fresh.size() > overlap)
+			m_decls.insert(m_decls.begin() + first + overlap, std::make_move_iterator(fresh.begin() + overlap), std::make_move_iterator(fresh.end()));
+		else
+			m_decls.erase(m_decls.begin() + first + overlap, m_decls.begin() + resume);
+
+		// Reused declarations after the edit moved along with the text, and every token view is stale if m_text reallocated
+		const bool moved = m_text.data() != old_data;
+		string_view text = m_text;
+		for (size_t i = moved ? 0 : first + fresh.size(); i < m_decls.size(); ++i) {
+			Decl& decl = m_decls[i];
+			if (i >= first + fresh.size()) {
+				decl.begin = decl.begin - removed + inserted.length();
+				decl.end = decl.end - removed + inserted.length();
+			}
+			decl.tokens.Rebase(text.substr(decl.begin, decl.length));
+		}
+
+		return edit;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include <cdecl/mappedfile.hpp>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+	#include <cerrno>
+	#include <cstring>
+#endif
+
+namespace Cdecl {
+#ifdef _WIN32
+	MappedFile::~MappedFile() {
+		if (m_data)
+			UnmapViewOfFile(m_data);
+		if (m_mapping)
+			CloseHandle(m_mapping);
+		if (m_file && m_file != INVALID_HANDLE_VALUE)
+			CloseHandle(m_file);
+	}
+
+	MappedFile::OpenResult MappedFile::Open(const char* path) {
+		std::shared_ptr<MappedFile> file = std::shared_ptr<MappedFile>(new MappedFile());
+
+		file->m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file->m_file == INVALID_HANDLE_VALUE)
+			return OpenResult::Err{ Format("Failed to open \"", path, "\" (error ", GetLastError(), ')').str() };
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file->m_file, &size))
+			return OpenResult::Err{ Format("Failed to get size of \"", path, "\" (error ", GetLastError(), ')').str() };
+		if (size.QuadPart == 0)
+			return OpenResult::Ok{ file };
+
+		file->m_mapping = CreateFileMappingA(file->m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!file->m_mapping)
+			return OpenResult::Err{ Format("Failed to map \"", path, "\" (error ", GetLastError(), ')').str() };
+
+		file->m_data = MapViewOfFile(file->m_mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!file->m_data)
+			return OpenResult::Err{ Format("Failed to map \"", path, "\" (error ", GetLastError(), ')').str() };
+
+		file->m_size = (size_t)size.QuadPart;
+		return OpenResult::Ok{ file };
+	}
+#else
+	MappedFile::~MappedFile() {
+		if (m_data)
+			munmap(const_cast<void*>(m_data), m_size);
+		if (m_fd >= 0)
+			close(m_fd);
+	}
+
+	MappedFile::OpenResult MappedFile::Open(const char* path) {
+		std::shared_ptr<MappedFile> file = std::shared_ptr<MappedFile>(new MappedFile());
+
+		file->m_fd = open(path, O_RDONLY);
+		if (file->m_fd < 0)
+			return OpenResult::Err{ Format("Failed to open \"", path, "\": ", std::strerror(errno)).str() };
+
+		struct stat info;
+		if (fstat(file->m_fd, &info) != 0)
+			return OpenResult::Err{ Format("Failed to stat \"", path, "\": ", std::strerror(errno)).str() };
+		if (info.st_size == 0)
+			return OpenResult::Ok{ file };
+
+		void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file->m_fd, 0);
+		if (data == MAP_FAILED)
+			return OpenResult::Err{ Format("Failed to map \"", path, "\": ", std::strerror(errno)).str() };
+
+		madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+		file->m_data = data;
+		file->m_size = (size_t)info.st_size;
+		return OpenResult::Ok{ file };
+	}
+#endif
+}
\ No newline at end of file
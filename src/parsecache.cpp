@@ -0,0 +1,152 @@
+#include <cdecl/c/parsecache.hpp>
+#include <cdecl/c/lexer.hpp>
+#include <cdecl/c/typedeftable.hpp>
+#include <cdecl/c/tagtable.hpp>
+#include <cdecl/parsestats.hpp>
+
+namespace Cdecl {
+	template <class T>
+	static void AppendBytes(string& key, const T& value) {
+		key.append((const char*)&value, sizeof(value));
+	}
+
+	/*
+	 * Everything in the context that changes what a parse returns. Results interned in one TypeTable must not be
+	 * handed to a caller using another. Typedefs and tags are only ever added, so a table's size doubles as its generation.
+	 */
+	static void AppendContext(string& key, const ParseContext& ctx) {
+		AppendBytes(key, ctx.types);
+		AppendBytes(key, ctx.typedefs);
+		AppendBytes(key, ctx.typedefs ? ctx.typedefs->Size() : 0);
+		AppendBytes(key, ctx.tags);
+		AppendBytes(key, ctx.tags ? ctx.tags->Size() : 0);
+		AppendBytes(key, ctx.pack);
+	}
+
+	// Joins tokens with single spaces, which lexes back to the same tokens regardless of the original spacing
+	static string MakeKey(char kind, uint32_t mask, const ParseContext& ctx, const TokenBuffer& tokens) {
+		string key;
+		key.reserve(tokens.Source().length() + 64);
+		key += kind;
+		AppendBytes(key, mask);
+		AppendContext(key, ctx);
+		for (size_t i = 0; i < tokens.Size(); ++i) {
+			if (i)
+				key += ' ';
+			key += tokens.View(i);
+		}
+		return key;
+	}
+
+	ParseContext ParseCache::MakeHeapContext(const ParseContext& ctx) {
+		ParseContext heap_ctx = ctx;
+		heap_ctx.arena = nullptr;
+		if (!heap_ctx.strings && !heap_ctx.types)
+			heap_ctx.strings = &m_strings;
+		return heap_ctx;
+	}
+
+	std::optional<ParseCache::Value> ParseCache::Find(const string& key) {
+		Shard& shard = GetShard(key);
+		std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(shard.mutex);
+
+		auto it = shard.index.find(key);
+		if (it == shard.index.end())
+			return {};
+
+		shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+		return it->second->value;
+	}
+
+	ParseCache::Value ParseCache::Insert(string&& key, Value&& value) {
+		Shard& shard = GetShard(key);
+		std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(shard.mutex);
+
+		// Another thread may have parsed the same text meanwhile. Keep its result so both callers share it.
+		auto it = shard.index.find(key);
+		if (it != shard.index.end()) {
+			shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+			return it->second->value;
+		}
+
+		shard.lru.push_front(Entry{ std::move(key), std::move(value) });
+		shard.index.emplace(shard.lru.front().key, shard.lru.begin());
+
+		while (shard.lru.size() > m_shard_capacity) {
+			shard.index.erase(shard.lru.back().key);
+			shard.lru.pop_back();
+			++m_evictions;
+		}
+		return shard.lru.front().value;
+	}
+
+	ParseCache::TypeResult ParseCache::ParseType(const string_view& text, TypeParseMask mask, const ParseContext& ctx) {
+		Lexer::ParseBufferResult lexed = Lexer::ParseBuffer(text);
+		if (!lexed)
+			return TypeResult::Err{ lexed.GetErr() };
+		const TokenBuffer& tokens = lexed.GetOk();
+
+		string key = MakeKey('T', (uint32_t)mask, ctx, tokens);
+		if (std::optional<Value> cached = Find(key)) {
+			++m_hits;
+			return TypeResult::Ok{ std::get<std::shared_ptr<const Type>>(cached.value()) };
+		}
+		++m_misses;
+
+		auto result = Type::Parse(TokenCursor(tokens), mask, MakeHeapContext(ctx));
+		if (!result)
+			return TypeResult::Err{ result.GetErr().Render(tokens) };
+
+		// The key covers every token, so a parse that stopped early must not be cached under it
+		size_t end = std::get<TokenCursor>(result.GetOk()).Pos();
+		if (end != tokens.Size())
+			return TypeResult::Err{ ParseError(ErrorCode::TrailingTokens, end).Render(tokens) };
+
+		Value value = std::get<std::shared_ptr<const Type>>(result.GetOk());
+		return TypeResult::Ok{ std::get<std::shared_ptr<const Type>>(Insert(std::move(key), std::move(value))) };
+	}
+
+	ParseCache::ProtoResult ParseCache::ParseFunctionProto(const string_view& text, const ParseContext& ctx) {
+		Lexer::ParseBufferResult lexed = Lexer::ParseBuffer(text);
+		if (!lexed)
+			return ProtoResult::Err{ lexed.GetErr() };
+		const TokenBuffer& tokens = lexed.GetOk();
+
+		string key = MakeKey('F', 0, ctx, tokens);
+		if (std::optional<Value> cached = Find(key)) {
+			++m_hits;
+			return ProtoResult::Ok{ std::get<std::shared_ptr<const FunctionProto>>(cached.value()) };
+		}
+		++m_misses;
+
+		auto result = FunctionProto::Parse(TokenCursor(tokens), MakeHeapContext(ctx));
+		if (!result)
+			return ProtoResult::Err{ result.GetErr().Render(tokens) };
+
+		size_t end = std::get<TokenCursor>(result.GetOk()).Pos();
+		if (end != tokens.Size())
+			return ProtoResult::Err{ ParseError(ErrorCode::TrailingTokens, end).Render(tokens) };
+
+		// The shared copy is a heap node like the ones the parser counts
+		Cdecl::Stats::Count(&ParseStats::allocations);
+		Value value = std::make_shared<const FunctionProto>(std::get<FunctionProto>(result.GetOk()));
+		return ProtoResult::Ok{ std::get<std::shared_ptr<const FunctionProto>>(Insert(std::move(key), std::move(value))) };
+	}
+
+	size_t ParseCache::Size() {
+		size_t size = 0;
+		for (Shard& shard : m_shards) {
+			std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(shard.mutex);
+			size += shard.lru.size();
+		}
+		return size;
+	}
+
+	void ParseCache::Clear() {
+		for (Shard& shard : m_shards) {
+			std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(shard.mutex);
+			shard.index.clear();
+			shard.lru.clear();
+		}
+	}
+}
\ No newline at end of file
@@ -1,64 +1,71 @@
-#include <cdecl/c/tokendefs.hpp>
-#include <cdecl/c/primitive.hpp>
-
-namespace Cdecl {
-	ParseResult<BaseType> BaseType::Parse(TokenCursor cur) {
-		uint8_t flags = 0;
-
-		while (const Token* tk = cur.Peek()) {
-			switch (tk->id) {
-			case TokenId::Const: flags |= Const; break;
-			case TokenId::Volatile: flags |= Volatile; break;
-			default:
-				tk = nullptr;
-			}
-
-			if (tk)
-				cur.Skip();
-			else
-				break;
-		}
-	}
-
-	ParseResult<Primitive> Primitive::Parse(TokenCursor cur) {
-		std::optional<BaseType> flags;
-		if (auto result = BaseType::Parse(cur)) {
-			flags = result.GetValue();
-			cur = result.GetCursor();
-		}
-		else
-			return ParseResult<Primitive>::Err(result.GetErr());
-
-		std::optional<EPrimitive> prim;
-		while (const Token* tk = cur.Peek()) {
-
-			switch (tk->id) {
-			case TokenId::Short:
-			case TokenId::Int:
-			case TokenId::Long:
-			case TokenId::Int8_t:
-			case TokenId::Int16_t:
-			case TokenId::Int32_t:
-			case TokenId::Int64_t:
-			case TokenId::Uint8_t:
-			case TokenId::Uint16_t:
-			case TokenId::Uint32_t:
-			case TokenId::Uint64_t:
-			case TokenId::Char:
-			case TokenId::Enum:
-			case TokenId::Float:
-			case TokenId::Double:
-			case TokenId::Struct:
-			case TokenId::Union:
-			case TokenId::Void:
-			default:
-				tk = nullptr;
-			}
-
-			if (tk)
-				cur.Skip();
-			else
-				break;
-		}
-	}
+#include <cdecl/c/tokendefs.hpp>
+#include <cdecl/c/primitive.hpp>
+
+namespace Cdecl {
+	ParseResult<BaseType> BaseType::Parse(TokenCursor cur) {
+		uint8_t flags = 0;
+
+		while (std::optional<Token> tk = cur.Peek()) {
+			switch (tk->id) {
+			case TokenId::Const: flags |= Const; break;
+			case TokenId::Volatile: flags |= Volatile; break;
+			default:
+				tk.reset();
+			}
+
+			if (tk)
+				cur.Skip();
+			else
+				break;
+		}
+
+		return ParseResult<BaseType>::Ok(BaseType(flags), cur);
+	}
+
+	ParseResult<Primitive> Primitive::Parse(TokenCursor cur) {
+		std::optional<BaseType> flags;
+		if (auto result = BaseType::Parse(cur)) {
+			flags = result.GetValue();
+			cur = result.GetCursor();
+		}
+		else
+			return ParseResult<Primitive>::Err(string(result.GetErr()));
+
+		std::optional<EPrimitive> prim;
+		while (std::optional<Token> tk = cur.Peek()) {
+			std::optional<EPrimitive> next;
+
+			switch (tk->id) {
+			case TokenId::Short: next = Short; break;
+			case TokenId::Int: next = prim.value_or(Int); break; // `short int`, `long int`
+			case TokenId::Long: next = prim == Long ? LongLong : Long; break;
+			case TokenId::Int8_t: next = Int8_t; break;
+			case TokenId::Int16_t: next = Int16_t; break;
+			case TokenId::Int32_t: next = Int32_t; break;
+			case TokenId::Int64_t: next = Int64_t; break;
+			case TokenId::Uint8_t: next = Uint8_t; break;
+			case TokenId::Uint16_t: next = Uint16_t; break;
+			case TokenId::Uint32_t: next = Uint32_t; break;
+			case TokenId::Uint64_t: next = Uint64_t; break;
+			case TokenId::Char: next = Char; break;
+			case TokenId::Enum: next = Enum; break;
+			case TokenId::Float: next = Float; break;
+			case TokenId::Double: next = Double; break;
+			case TokenId::Struct: next = Struct; break;
+			case TokenId::Union: next = Union; break;
+			case TokenId::Void: next = Void; break;
+			default:
+				break;
+			}
+
+			if (!next.has_value())
+				break;
+			prim = next;
+			cur.Skip();
+		}
+
+		if (!prim.has_value())
+			return ParseResult<Primitive>::Err(Format("Expected a primitive type at token ", cur.Pos()).str());
+		return ParseResult<Primitive>::Ok(Primitive(flags.value(), prim.value()), cur);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include <cdecl/c/record.hpp>
+#include <algorithm>
+
+namespace Cdecl {
+	static uint64_t AlignUp(uint64_t value, uint64_t align) {
+		return (value + align - 1) / align * align;
+	}
+
+	static std::optional<TypeLayout> GetPrimitiveLayout(const Type& type, Abi abi) {
+		switch (type.GetPrimitiveType()) {
+		case Type::Primitive::Int8_t:
+		case Type::Primitive::Uint8_t:
+		case Type::Primitive::Char:
+			return TypeLayout{ 1, 1 };
+		case Type::Primitive::Int16_t:
+		case Type::Primitive::Uint16_t:
+			return TypeLayout{ 2, 2 };
+		case Type::Primitive::Int32_t:
+		case Type::Primitive::Uint32_t:
+		case Type::Primitive::Enum:
+		case Type::Primitive::Float:
+			return TypeLayout{ 4, 4 };
+		case Type::Primitive::Int64_t:
+		case Type::Primitive::Uint64_t:
+			return TypeLayout{ 8, 8 };
+		case Type::Primitive::Int:
+			if (type.IsLongLong())
+				return TypeLayout{ 8, 8 };
+			if (type.IsLong()) // LP64 vs LLP64
+				return abi == Abi::SysV_x64 ? TypeLayout{ 8, 8 } : TypeLayout{ 4, 4 };
+			if (type.IsShort())
+				return TypeLayout{ 2, 2 };
+			return TypeLayout{ 4, 4 };
+		case Type::Primitive::Double:
+			if (type.IsLong()) // MSVC's long double is a plain double
+				return abi == Abi::SysV_x64 ? TypeLayout{ 16, 16 } : TypeLayout{ 8, 8 };
+			return TypeLayout{ 8, 8 };
+		default:
+			return {};
+		}
+	}
+
+	std::optional<TypeLayout> GetTypeLayout(const Type& type, Abi abi) {
+		if (type.IsPointer())
+			return abi == Abi::Win32 ? TypeLayout{ 4, 4 } : TypeLayout{ 8, 8 };
+		if (type.IsPrimitive())
+			return GetPrimitiveLayout(type, abi);
+		if (type.IsRecord()) {
+			if (const RecordLayout* layout = type.GetRecord()->GetLayout(abi))
+				return TypeLayout{ layout->size, layout->align };
+		}
+		return {};
+	}
+
+	static size_t HashRecord(const Record& record) {
+		size_t h = std::hash<string_view>()(record.GetTag());
+		h = HashCombine(h, record.IsUnion() | record.IsComplete() << 1);
+		h = HashCombine(h, record.GetPack());
+		for (const Variable& member : record.GetMembers()) {
+			h = HashCombine(h, member.GetType()->Hash());
+			h = HashCombine(h, std::hash<string_view>()(member.GetName()));
+		}
+		return h;
+	}
+
+	Record::Record(Name tag, bool is_union) : m_tag(std::move(tag)), m_union(is_union), m_complete(false), m_pack(0) {
+		m_hash = HashRecord(*this);
+	}
+
+	Record::Record(Name tag, bool is_union, ArenaVector<Variable>&& members, uint32_t pack)
+		: m_tag(std::move(tag)), m_union(is_union), m_complete(true), m_pack(pack), m_members(std::move(members)), m_index(0, Index::hasher(), Index::key_equal(), m_members.get_allocator())
+	{
+		m_index.reserve(m_members.size());
+		for (size_t i = 0; i < m_members.size(); ++i)
+			m_index.emplace(m_members[i].GetName(), i);
+		m_hash = HashRecord(*this);
+	}
+
+	bool Record::operator==(const Record& other) const {
+		if (this == &other)
+			return true;
+		if (m_hash != other.m_hash || GetTag() != other.GetTag() || m_union != other.m_union || m_complete != other.m_complete
+			|| m_pack != other.m_pack || m_members.size() != other.m_members.size())
+			return false;
+
+		for (size_t i = 0; i < m_members.size(); ++i) {
+			const Variable& a = m_members[i];
+			const Variable& b = other.m_members[i];
+			if (a.GetName() != b.GetName() || (a.GetType() != b.GetType() && *a.GetType() != *b.GetType()))
+				return false;
+		}
+		return true;
+	}
+
+	const RecordLayout* Record::GetLayout(Abi abi) const {
+		size_t index = (size_t)abi;
+
+		std::call_once(m_layout_once[index], [&]() {
+			if (!m_complete)
+				return;
+
+			// Struct rules match on both ABIs once primitive sizes are known. Empty records are 0 bytes, as in GNU C.
+			RecordLayout layout = RecordLayout{ 0, 1, {} };
+			layout.offsets.reserve(m_members.size());
+
+			for (const Variable& member : m_members) {
+				std::optional<TypeLayout> member_layout = GetTypeLayout(*member.GetType(), abi);
+				if (!member_layout.has_value())
+					return;
+
+				uint64_t align = m_pack ? std::min<uint64_t>(member_layout->align, m_pack) : member_layout->align;
+				uint64_t offset = m_union ? 0 : AlignUp(layout.size, align);
+				layout.offsets.push_back(offset);
+				layout.size = std::max(layout.size, offset + member_layout->size);
+				layout.align = std::max(layout.align, align);
+			}
+
+			layout.size = AlignUp(layout.size, layout.align);
+			m_layouts[index] = std::move(layout);
+		});
+
+		return m_layouts[index].has_value() ? &m_layouts[index].value() : nullptr;
+	}
+}
\ No newline at end of file
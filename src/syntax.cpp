@@ -1,301 +1,568 @@
-#include <cdecl/c/syntax.hpp>
-#include <cdecl/c/type.hpp>
-
-namespace Cdecl {
-	bool Type::IsPrimitiveIntegral(Primitive p) {
-		switch (p) {
-		case Primitive::Int8_t:
-		case Primitive::Int16_t:
-		case Primitive::Int32_t:
-		case Primitive::Int64_t:
-		case Primitive::Uint8_t:
-		case Primitive::Uint16_t:
-		case Primitive::Uint32_t:
-		case Primitive::Uint64_t:
-		case Primitive::Char:
-		case Primitive::Int:
-			return true;
-		default:
-			return false;
-		}
-	}
-	bool Type::IsPrimitiveNumeric(Primitive p) {
-		if (IsPrimitiveIntegral(p))
-			return true;
-		switch (p) {
-		case Primitive::Float:
-		case Primitive::Double:
-			return true;
-		default:
-			return false;
-		}
-	}
-
-	Type::Flags::ParseResult Type::Flags::Parse(TokenCursor cur) {
-		// TODO: Separate flags parser for INT flags, POINTER flags, and CALL CONV flags
-		// TODO: Separate "pointer" type structure
-
-		uint32_t flags = 0;
-		std::optional<CallConvention> call_conv;
-		int call_conv_counter = 0;
-
-		while (const Token* tk_flag = cur.MatchAny(
-			TokenId::Const, TokenId::Volatile, TokenId::Signed, TokenId::Unsigned, TokenId::Short, TokenId::Long,
-			TokenId::Cdecl, TokenId::Stdcall, TokenId::Fastcall, TokenId::Thiscall, TokenId::Vectorcall
-		))
-		{
-			size_t begin = cur.Pos();
-
-			switch (tk_flag->id) {
-			case TokenId::Const: flags |= Flags::Const; break;
-			case TokenId::Volatile: flags |= Flags::Volatile; break;
-			case TokenId::Signed: flags |= Flags::Signed; break;
-			case TokenId::Unsigned: flags |= Flags::Unsigned; break;
-			case TokenId::Short: flags |= Flags::Short; break;
-			case TokenId::Long:
-				if (flags & Flags::Long)
-					flags = (flags & ~Flags::Long) | Flags::LongLong;
-				else if (flags & Flags::LongLong)
-					return ParseResult::Err{ cur.FormatWithLoc(begin, "Invalid combination of 'long' specifiers").str() };
-				else
-					flags |= Flags::Long;
-				break;
-
-			case TokenId::Cdecl:
-				call_conv = CallConvention::Cdecl, ++call_conv_counter; break;
-			case TokenId::Stdcall:
-				call_conv = CallConvention::Stdcall, ++call_conv_counter; break;
-			case TokenId::Fastcall:
-				call_conv = CallConvention::Fastcall, ++call_conv_counter; break;
-			case TokenId::Thiscall:
-				call_conv = CallConvention::Thiscall, ++call_conv_counter; break;
-			case TokenId::Vectorcall:
-				call_conv = CallConvention::Vectorcall, ++call_conv_counter; break;
-
-			default:
-				return ParseResult::Err{ cur.FormatWithLoc(begin, "Unhandled token id ", tk_flag->id).str() };
-			}
-
-			if (call_conv_counter > 1)
-				return ParseResult::Err{ cur.FormatWithLoc(begin, "Cannot specify multiple calling conventions").str() };
-		}
-
-		return ParseResult::Ok{ std::pair(Flags{flags, call_conv}, cur) };
-	}
-	Type::Flags::CombineResult Type::Flags::Combine(const Flags& other) const {
-		std::optional<CallConvention> new_call_conv = call_conv;
-		if (other.call_conv.has_value()) {
-			if (new_call_conv.has_value())
-				return CombineResult::Err{ "Cannot specify multiple calling conventions" };
-			else
-				new_call_conv = other.call_conv;
-		}
-
-		uint32_t new_flags = bits | other.bits;
-		if (bits & Flags::Long && other.bits & Flags::Long) {
-			new_flags &= ~Flags::Long;
-			new_flags |= Flags::LongLong;
-		}
-
-		uint32_t overlap = bits & other.bits;
-		bool overlapping_long = bits & Flags::LongLong && overlap & (Flags::Long | Flags::LongLong);
-		bool long_and_short = false;
-		if (bits & Flags::Short)
-			long_and_short = bits & (Flags::Long | Flags::LongLong);
-
-		if (overlapping_long)
-			return CombineResult::Err{ "Invalid combination of 'long' specifiers" };
-		else if (long_and_short)
-			return CombineResult::Err{ "Cannot specify 'long' and 'short' together" };
-
-		return CombineResult::Ok{ Flags{new_flags, new_call_conv} };
-	}
-
-	Type::ParsePrimitiveResult Type::ParsePrimitive(TokenCursor cur, TypeParseMask mask) {
-		size_t begin = cur.Pos();
-
-		const Token* tk_prim = cur.MatchAny(
-			TokenId::Int8_t, TokenId::Int16_t, TokenId::Int32_t, TokenId::Int64_t,
-			TokenId::Uint8_t, TokenId::Uint16_t, TokenId::Uint32_t, TokenId::Uint64_t,
-			TokenId::Char, TokenId::Int, TokenId::Float, TokenId::Double, TokenId::Void
-		);
-
-		if (!tk_prim)
-			return ParsePrimitiveResult::Err{ cur.FormatWithLoc(begin, "Expected a primitive numerical type or void").str() };
-
-		Primitive prim;
-
-		switch (tk_prim->id) {
-		case TokenId::Int8_t:	prim = Primitive::Int8_t; break;
-		case TokenId::Int16_t:	prim = Primitive::Int16_t; break;
-		case TokenId::Int32_t:	prim = Primitive::Int32_t; break;
-		case TokenId::Int64_t:	prim = Primitive::Int64_t; break;
-		case TokenId::Uint8_t:	prim = Primitive::Uint8_t; break;
-		case TokenId::Uint16_t:	prim = Primitive::Uint16_t; break;
-		case TokenId::Uint32_t:	prim = Primitive::Uint32_t; break;
-		case TokenId::Uint64_t:	prim = Primitive::Uint64_t; break;
-		case TokenId::Char:		prim = Primitive::Char; break;
-		case TokenId::Int:		prim = Primitive::Int; break;
-		case TokenId::Double:	prim = Primitive::Double; break;
-		case TokenId::Void:		prim = Primitive::Void; break;
-		default: {
-			return ParsePrimitiveResult::Err{ cur.FormatWithLoc(begin, "Unhandled token id ", tk_prim->id).str() };
-		}
-		}
-
-		return ParsePrimitiveResult::Ok{ std::pair(prim, cur) };
-	}
-	Type::ParseBaseTypeResult Type::ParseBaseType(TokenCursor cur, TypeParseMask mask) {
-		size_t begin = cur.Pos();
-
-		Flags flags_prefix;
-		if (auto result = Flags::Parse(cur)) {
-			flags_prefix = std::get<Flags>(result.GetOk());
-			cur = std::get<TokenCursor>(result.GetOk());
-		}
-		else
-			return ParseBaseTypeResult::Err{ result.GetErr() };
-
-		Primitive prim;
-		if (auto result = ParsePrimitive(cur, mask)) {
-			prim = std::get<Primitive>(result.GetOk());
-			cur = std::get<TokenCursor>(result.GetOk());
-		}
-		else {
-			if (flags_prefix.bits & FLAGS_INT)
-				prim = Primitive::Int; // Default to int if int-related flags are given
-			else
-				return ParseBaseTypeResult::Err{ result.GetErr() };
-		}
-
-		Flags flags_postfix;
-		if (auto result = Flags::Parse(cur)) {
-			flags_postfix = std::get<Flags>(result.GetOk());
-			cur = std::get<TokenCursor>(result.GetOk());
-		}
-		else
-			return ParseBaseTypeResult::Err{ result.GetErr() };
-
-		// TODO: Write a helper function to validate type specifiers (and create a cleaned-up type)
-
-		Flags flags;
-		if (auto result = flags_prefix.Combine(flags_postfix))
-			flags = result.GetOk();
-		else
-			return ParseBaseTypeResult::Err{ cur.FormatWithLoc(begin, result.GetErr()).str() };
-
-		if (prim == Primitive::Float || prim == Primitive::Double) {
-			if (flags.bits & BADFLAGS_FLOAT)
-				return ParseBaseTypeResult::Err{ cur.FormatWithLoc(begin, "Invalid combination of type specifiers").str() };
-
-			// MSVC allows `long float` to mean `double`
-			if (prim == Primitive::Float && flags.bits & Flags::Long) {
-				flags.bits &= ~Flags::Long;
-				prim = Primitive::Double;
-			}
-		}
-		else if (!IsPrimitiveIntegral(prim) && flags.bits & FLAGS_INT)
-			return ParseBaseTypeResult::Err{ cur.FormatWithLoc(begin, "Cannot use integer-only type specifiers on a non-integer").str() };
-
-		return ParseBaseTypeResult::Ok{ std::pair(std::make_shared<Type>(prim, flags), cur) };
-	}
-	Type::ParseResult Type::Parse(TokenCursor cur, TypeParseMask mask) {
-		std::shared_ptr<const Type> base_type;
-		if (auto result = ParseBaseType(cur, mask)) {
-			base_type = std::get<std::shared_ptr<const Type>>(result.GetOk());
-			cur = std::get<TokenCursor>(result.GetOk());
-		}
-		else
-			return ParseResult::Err{ result.GetErr() };
-
-		while (cur.Match(TokenId::Asterisk)) {
-			size_t begin = cur.Pos();
-
-			Flags flags;
-			if (auto result = Flags::Parse(cur)) {
-				flags = std::get<Flags>(result.GetOk());
-				cur = std::get<TokenCursor>(result.GetOk());
-			}
-			else
-				return ParseResult::Err{ cur.FormatWithLoc(begin, result.GetErr()).str() };
-
-			if (flags.bits & FLAGS_INT)
-				return ParseResult::Err{ cur.FormatWithLoc(begin, "Cannot use integer-only type specifiers on a pointer").str() };
-
-			flags.bits |= Flags::Pointer;
-			base_type = std::make_shared<Type>(std::move(base_type), flags);
-		}
-
-		return ParseResult::Ok{ std::pair(base_type, cur) };
-	}
-
-	Variable::ParseResult Variable::Parse(TokenCursor cur, TypeParseMask mask) {
-		std::shared_ptr<const Type> type;
-		if (auto result = Type::Parse(cur, mask)) {
-			type = std::get<std::shared_ptr<const Type>>(result.GetOk());
-			cur = std::get<TokenCursor>(result.GetOk());
-		}
-		else
-			return ParseResult::Err{ result.GetErr() };
-	}
-
-	Argument::ParseResult Argument::Parse(TokenCursor cur) {
-		static const TypeParseMask mask = ParseMaskBlacklist(TypeParseMask::Structs);
-		size_t begin = cur.Pos();
-
-		if (cur.MatchSequence(TokenId::Period, TokenId::Period, TokenId::Period))
-			return ParseResult::Ok{ std::pair(Argument(), cur) };
-
-		std::shared_ptr<const Type> type;
-		if (auto result = Type::Parse(cur, mask)) {
-			type = std::get<std::shared_ptr<const Type>>(result.GetOk());
-			cur = std::get<TokenCursor>(result.GetOk());
-		}
-		else
-			return ParseResult::Err{ result.GetErr() };
-
-		if (type->HasDecl()) {
-			Variable var = Variable(type, std::string(type->GetDecl()));
-			return ParseResult::Ok{ std::pair(Argument(std::move(var)), cur) };
-		}
-		else
-			return ParseResult::Ok{ std::pair(Argument(type), cur) };
-	}
-
-	FunctionProto::ParseResult FunctionProto::Parse(TokenCursor cur) {
-		/*
-		TODO: Include calling conventions as a type specifier.
-		Variable::Parse() should scream if any calling convention is set
-		Argument::Parse() will use Variable::Parse(), propogating that check
-
-		This also begs the questions:
-		Should Type contain both 'name' and 'conv' attributes on its own?
-		Even if not, conv needs to be parsed by it. How would they be shared privately?
-		*/
-
-		std::shared_ptr<const Type> ret_type;
-		if (auto result = Type::Parse(cur, ParseMaskBlacklist())) {
-			ret_type = std::get<std::shared_ptr<const Type>>(result.GetOk());
-			cur = std::get<TokenCursor>(result.GetOk());
-		}
-		else
-			return ParseResult::Err{ result.GetErr() };
-
-		string name;
-		if (const Token* tk_name = cur.Match(TokenId::Identifier))
-			name = tk_name->view;
-		else
-			return ParseResult::Err{ cur.FormatWithLoc(cur.Pos(), "Expected an identifier").str() };
-
-		if (!cur.Match(TokenId::Round_Open))
-			return ParseResult::Err{ cur.FormatWithLoc(cur.Pos(), "Expected function arguments in parentheses").str() };
-
-		std::vector<Argument> args;
-
-		size_t begin = cur.Pos();
-		while (auto result = Argument::Parse(cur)) {
-
-			begin = cur.Pos();
-		}
-	}
+#include <cdecl/c/syntax.hpp>
+#include <cdecl/c/type.hpp>
+#include <cdecl/c/typetable.hpp>
+#include <cdecl/c/typedeftable.hpp>
+#include <cdecl/c/tagtable.hpp>
+#include <cdecl/c/record.hpp>
+#include <cdecl/arena.hpp>
+#include <cdecl/stringpool.hpp>
+#include <cdecl/parsestats.hpp>
+#include <array>
+
+namespace Cdecl {
+	bool Type::IsPrimitiveIntegral(Primitive p) {
+		switch (p) {
+		case Primitive::Int8_t:
+		case Primitive::Int16_t:
+		case Primitive::Int32_t:
+		case Primitive::Int64_t:
+		case Primitive::Uint8_t:
+		case Primitive::Uint16_t:
+		case Primitive::Uint32_t:
+		case Primitive::Uint64_t:
+		case Primitive::Char:
+		case Primitive::Int:
+			return true;
+		default:
+			return false;
+		}
+	}
+	bool Type::IsPrimitiveNumeric(Primitive p) {
+		if (IsPrimitiveIntegral(p))
+			return true;
+		switch (p) {
+		case Primitive::Float:
+		case Primitive::Double:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	/*
+	 * Tables for the declaration specifier state machine in Flags::Parse.
+	 * Each specifier token maps to a kind and an index. Sign and size modifiers then step through small transition tables,
+	 * so every illegal combination (`long short`, `long long long`, `signed unsigned`) is a table entry instead of a branch.
+	 */
+	namespace SpecifierTables {
+		enum Kind : uint8_t {
+			NotSpecifier,
+			Qualifier, // index: 0 const, 1 volatile
+			Sign, // index: 0 signed, 1 unsigned
+			Size, // index: 0 short, 1 long
+			CallConv, // index: CallConvention
+			Prim, // index: Type::Primitive
+		};
+
+		struct SpecifierDef {
+			Kind kind;
+			uint8_t index;
+		};
+
+		constexpr std::array<SpecifierDef, 64> MakeDefs() {
+			std::array<SpecifierDef, 64> defs = {};
+			defs[TokenId::Const] = { Qualifier, 0 };
+			defs[TokenId::Volatile] = { Qualifier, 1 };
+			defs[TokenId::Signed] = { Sign, 0 };
+			defs[TokenId::Unsigned] = { Sign, 1 };
+			defs[TokenId::Short] = { Size, 0 };
+			defs[TokenId::Long] = { Size, 1 };
+			defs[TokenId::Cdecl] = { CallConv, (uint8_t)CallConvention::Cdecl };
+			defs[TokenId::Stdcall] = { CallConv, (uint8_t)CallConvention::Stdcall };
+			defs[TokenId::Fastcall] = { CallConv, (uint8_t)CallConvention::Fastcall };
+			defs[TokenId::Thiscall] = { CallConv, (uint8_t)CallConvention::Thiscall };
+			defs[TokenId::Vectorcall] = { CallConv, (uint8_t)CallConvention::Vectorcall };
+			defs[TokenId::Int8_t] = { Prim, (uint8_t)Type::Primitive::Int8_t };
+			defs[TokenId::Int16_t] = { Prim, (uint8_t)Type::Primitive::Int16_t };
+			defs[TokenId::Int32_t] = { Prim, (uint8_t)Type::Primitive::Int32_t };
+			defs[TokenId::Int64_t] = { Prim, (uint8_t)Type::Primitive::Int64_t };
+			defs[TokenId::Uint8_t] = { Prim, (uint8_t)Type::Primitive::Uint8_t };
+			defs[TokenId::Uint16_t] = { Prim, (uint8_t)Type::Primitive::Uint16_t };
+			defs[TokenId::Uint32_t] = { Prim, (uint8_t)Type::Primitive::Uint32_t };
+			defs[TokenId::Uint64_t] = { Prim, (uint8_t)Type::Primitive::Uint64_t };
+			defs[TokenId::Char] = { Prim, (uint8_t)Type::Primitive::Char };
+			defs[TokenId::Int] = { Prim, (uint8_t)Type::Primitive::Int };
+			defs[TokenId::Float] = { Prim, (uint8_t)Type::Primitive::Float };
+			defs[TokenId::Double] = { Prim, (uint8_t)Type::Primitive::Double };
+			defs[TokenId::Void] = { Prim, (uint8_t)Type::Primitive::Void };
+			return defs;
+		}
+
+		constexpr std::array<SpecifierDef, 64> defs = MakeDefs();
+
+		struct Step {
+			uint8_t next;
+			ErrorCode err;
+			bool ok;
+		};
+
+		constexpr Step Go(uint8_t next) { return Step{ next, ErrorCode::UnhandledToken, true }; }
+		constexpr Step Fail(ErrorCode err) { return Step{ 0, err, false }; }
+
+		enum SignState : uint8_t { NoSign, Signed, Unsigned };
+		enum SizeState : uint8_t { NoSize, Short, Long, LongLong };
+
+		// [state][index]
+		constexpr Step sign_steps[3][2] = {
+			{ Go(Signed), Go(Unsigned) },
+			{ Fail(ErrorCode::InvalidSpecifiers), Fail(ErrorCode::InvalidSpecifiers) },
+			{ Fail(ErrorCode::InvalidSpecifiers), Fail(ErrorCode::InvalidSpecifiers) },
+		};
+		constexpr Step size_steps[4][2] = {
+			{ Go(Short), Go(Long) },
+			{ Fail(ErrorCode::InvalidSpecifiers), Fail(ErrorCode::LongAndShort) },
+			{ Fail(ErrorCode::LongAndShort), Go(LongLong) },
+			{ Fail(ErrorCode::LongAndShort), Fail(ErrorCode::InvalidLong) },
+		};
+
+		// Which sign/size flags each primitive accepts, and the error when it gets any others
+		struct PrimitiveRule {
+			uint32_t allowed;
+			ErrorCode err;
+		};
+
+		constexpr std::array<PrimitiveRule, 16> MakePrimitiveRules(uint32_t int_flags, uint32_t float_flags) {
+			std::array<PrimitiveRule, 16> rules = {};
+			for (PrimitiveRule& rule : rules)
+				rule = { 0, ErrorCode::IntSpecifiersOnNonInt };
+
+			for (Type::Primitive prim : {
+				Type::Primitive::Int8_t, Type::Primitive::Int16_t, Type::Primitive::Int32_t, Type::Primitive::Int64_t,
+				Type::Primitive::Uint8_t, Type::Primitive::Uint16_t, Type::Primitive::Uint32_t, Type::Primitive::Uint64_t,
+				Type::Primitive::Char, Type::Primitive::Int,
+			})
+				rules[(size_t)prim] = { int_flags, ErrorCode::InvalidSpecifiers };
+
+			rules[(size_t)Type::Primitive::Float] = { float_flags, ErrorCode::InvalidSpecifiers };
+			rules[(size_t)Type::Primitive::Double] = { float_flags, ErrorCode::InvalidSpecifiers };
+			return rules;
+		}
+	}
+
+	Type::Flags::ParseResult Type::Flags::Parse(TokenCursor cur, std::optional<Primitive>* prim) {
+		using namespace SpecifierTables;
+
+		static constexpr uint32_t qualifier_bits[] = { Flags::Const, Flags::Volatile };
+		static constexpr uint32_t sign_bits[] = { 0, Flags::Signed, Flags::Unsigned };
+		static constexpr uint32_t size_bits[] = { 0, Flags::Short, Flags::Long, Flags::LongLong };
+
+		const TokenSet accepted = prim ? TokenClass::DeclSpecifier : TokenClass::TypeSpecifier;
+
+		uint32_t qualifiers = 0;
+		uint8_t sign = NoSign;
+		uint8_t size = NoSize;
+		std::optional<CallConvention> call_conv;
+
+		while (std::optional<Token> tk = cur.PeekClass(accepted)) {
+			const SpecifierDef& def = defs[tk->id];
+			Step step = Go(0);
+
+			switch (def.kind) {
+			case Qualifier: qualifiers |= qualifier_bits[def.index]; break;
+			case Sign:
+				step = sign_steps[sign][def.index];
+				sign = step.next;
+				break;
+			case Size:
+				step = size_steps[size][def.index];
+				size = step.next;
+				break;
+			case CallConv:
+				if (call_conv.has_value())
+					step = Fail(ErrorCode::MultipleCallConventions);
+				call_conv = (CallConvention)def.index;
+				break;
+			case Prim:
+				if (prim->has_value())
+					step = Fail(ErrorCode::InvalidSpecifiers);
+				*prim = (Primitive)def.index;
+				break;
+			default:
+				step = Fail(ErrorCode::UnhandledToken);
+			}
+
+			if (!step.ok)
+				return ParseResult::Err{ ParseError(step.err, cur.Pos(), step.err == ErrorCode::UnhandledToken ? tk->id : 0) };
+			cur.Skip();
+		}
+
+		return ParseResult::Ok{ std::pair(Flags{ qualifiers | sign_bits[sign] | size_bits[size], call_conv }, cur) };
+	}
+
+	size_t Type::ComputeHash() const {
+		size_t h = m_base.index();
+
+		if (IsPrimitive())
+			h = HashCombine(h, (size_t)GetPrimitiveType());
+		else if (IsFunctionProto())
+			h = HashCombine(h, GetFunctionProto()->Hash());
+		else if (IsRecord())
+			h = HashCombine(h, GetRecord()->Hash());
+		else
+			h = HashCombine(h, GetPointedType()->Hash());
+
+		h = HashCombine(h, m_flags.bits);
+		h = HashCombine(h, m_flags.call_conv.has_value() ? (size_t)m_flags.call_conv.value() + 1 : 0);
+		if (m_decl.has_value())
+			h = HashCombine(h, std::hash<string_view>()(m_decl.value()));
+		return h;
+	}
+
+	// Identical nodes are equal without looking inside, which is the common case for types from one TypeTable
+	template <class T>
+	static bool SameOrEqual(const std::shared_ptr<const T>& a, const std::shared_ptr<const T>& b) {
+		return a == b || *a == *b;
+	}
+
+	bool Type::operator==(const Type& other) const {
+		if (this == &other)
+			return true;
+		if (m_hash != other.m_hash || m_base.index() != other.m_base.index())
+			return false;
+		if (m_flags.bits != other.m_flags.bits || m_flags.call_conv != other.m_flags.call_conv || m_decl != other.m_decl)
+			return false;
+
+		if (IsPrimitive())
+			return GetPrimitiveType() == other.GetPrimitiveType();
+		if (IsFunctionProto())
+			return SameOrEqual(GetFunctionProto(), other.GetFunctionProto());
+		if (IsRecord())
+			return SameOrEqual(GetRecord(), other.GetRecord());
+		return SameOrEqual(GetPointedType(), other.GetPointedType());
+	}
+
+	size_t FunctionProto::ComputeHash(string_view name, const Type& ret_type, const ArenaVector<Argument>& args) {
+		size_t h = std::hash<string_view>()(name);
+		h = HashCombine(h, ret_type.Hash());
+		for (const Argument& arg : args) {
+			if (arg.IsVariadic())
+				h = HashCombine(h, 1);
+			else if (arg.IsType())
+				h = HashCombine(h, arg.GetType()->Hash());
+			else {
+				h = HashCombine(h, arg.GetVar().GetType()->Hash());
+				h = HashCombine(h, std::hash<string_view>()(arg.GetVar().GetName()));
+			}
+		}
+		return h;
+	}
+
+	bool FunctionProto::operator==(const FunctionProto& other) const {
+		if (this == &other)
+			return true;
+		if (m_hash != other.m_hash || GetName() != other.GetName() || m_args.size() != other.m_args.size())
+			return false;
+		if (!SameOrEqual(m_ret_type, other.m_ret_type))
+			return false;
+
+		for (size_t i = 0; i < m_args.size(); ++i) {
+			const Argument& a = m_args[i];
+			const Argument& b = other.m_args[i];
+			if (a.IsVariadic() || b.IsVariadic()) {
+				if (a.IsVariadic() != b.IsVariadic())
+					return false;
+			}
+			else if (a.IsType() != b.IsType())
+				return false;
+			else if (a.IsType()) {
+				if (!SameOrEqual(a.GetType(), b.GetType()))
+					return false;
+			}
+			else if (a.GetVar().GetName() != b.GetVar().GetName() || !SameOrEqual(a.GetVar().GetType(), b.GetVar().GetType()))
+				return false;
+		}
+		return true;
+	}
+
+	// Interned nodes outlive any arena, so everything they point at must too
+	static Arena* NodeArena(const ParseContext& ctx) {
+		return ctx.types ? nullptr : ctx.arena;
+	}
+
+	std::shared_ptr<const Type> Type::Make(const ParseContext& ctx, Type&& type) {
+		if (ctx.types)
+			return ctx.types->Intern(std::move(type));
+		if (ctx.arena)
+			return ctx.arena->MakeShared<const Type>(std::move(type));
+		Stats::Count(&ParseStats::allocations);
+		return std::make_shared<Type>(std::move(type));
+	}
+
+	template <class ...TArgs>
+	static std::shared_ptr<const Record> MakeRecord(const ParseContext& ctx, TArgs&&... args) {
+		if (Arena* arena = NodeArena(ctx))
+			return arena->MakeShared<const Record>(std::forward<TArgs>(args)...);
+		Stats::Count(&ParseStats::allocations);
+		return std::make_shared<const Record>(std::forward<TArgs>(args)...);
+	}
+
+	// Without anywhere longer-lived to put it, the name gets a heap copy of its own rather than viewing the token source
+	static Name InternName(const ParseContext& ctx, string_view name) {
+		if (ctx.strings)
+			return ctx.strings->Intern(name);
+		if (ctx.types)
+			return ctx.types->GetStrings().Intern(name);
+		if (ctx.arena)
+			return ctx.arena->Copy(name);
+		Stats::Count(&ParseStats::allocations);
+		return Name(std::make_shared<const string>(name));
+	}
+
+	static std::shared_ptr<const Type> FindTypedef(const TokenCursor& cur, const ParseContext& ctx) {
+		if (!ctx.typedefs)
+			return nullptr;
+		std::optional<Token> tk_name = cur.PeekClass(TokenSet(TokenId::Identifier));
+		return tk_name ? ctx.typedefs->Find(tk_name->view) : nullptr;
+	}
+
+	Type::ParseBaseTypeResult Type::ParseRecord(TokenCursor cur, TypeParseMask mask, const ParseContext& ctx) {
+		bool is_union = cur.Skip()->id == TokenId::Union;
+
+		size_t tag_pos = cur.Pos();
+		std::optional<Token> tk_tag = cur.Match(TokenId::Identifier);
+
+		// Member lists are only allowed where the mask permits structs. A bare tag names its definition, if any, or an incomplete record.
+		bool allow_body = (uint32_t)mask & (uint32_t)TypeParseMask::Structs;
+		if (!allow_body || !cur.Match(TokenId::Curly_Open)) {
+			if (!tk_tag) {
+				TokenSet expected = allow_body ? TokenSet(TokenId::Identifier, TokenId::Curly_Open) : TokenSet(TokenId::Identifier);
+				return ParseBaseTypeResult::Err{ ParseError(ErrorCode::ExpectedRecordBody, cur.Pos(), 0, expected) };
+			}
+
+			std::shared_ptr<const Record> record = ctx.tags ? ctx.tags->Find(tk_tag->view) : nullptr;
+			if (record && record->IsUnion() != is_union)
+				return ParseBaseTypeResult::Err{ ParseError(ErrorCode::TagRedefinition, tag_pos) };
+			if (!record)
+				record = MakeRecord(ctx, InternName(ctx, tk_tag->view), is_union);
+			return ParseBaseTypeResult::Ok{ std::pair(Make(ctx, Type(record)), cur) };
+		}
+
+		// A definition kept by the tag table has to outlive the parse, so it goes to a TypeTable rather than the arena
+		const bool define = ctx.tags && tk_tag;
+		ParseContext body_ctx = ctx;
+		if (define && !body_ctx.types)
+			body_ctx.types = &ctx.tags->GetTypes();
+		Name tag = tk_tag ? InternName(body_ctx, tk_tag->view) : Name();
+
+		ArenaVector<Variable> members = ArenaVector<Variable>(NodeArena(body_ctx));
+		while (!cur.Match(TokenId::Curly_Close)) {
+			if (auto result = Variable::Parse(cur, ParseMaskBlacklist(), body_ctx)) {
+				members.push_back(std::get<Variable>(result.GetOk()));
+				cur = std::get<TokenCursor>(result.GetOk());
+			}
+			else
+				return ParseBaseTypeResult::Err{ result.GetErr() };
+
+			if (!cur.Match(TokenId::Semicolon))
+				return ParseBaseTypeResult::Err{ ParseError(ErrorCode::ExpectedSemicolon, cur.Pos(), 0, TokenSet(TokenId::Semicolon)) };
+		}
+
+		std::shared_ptr<const Record> record = MakeRecord(body_ctx, tag, is_union, std::move(members), ctx.pack);
+		if (define) {
+			if (!ctx.tags->Define(record))
+				return ParseBaseTypeResult::Err{ ParseError(ErrorCode::TagRedefinition, tag_pos) };
+			record = ctx.tags->Find(tag);
+		}
+		return ParseBaseTypeResult::Ok{ std::pair(Make(ctx, Type(record)), cur) };
+	}
+
+	Type::ParseBaseTypeResult Type::ParseNamedType(std::shared_ptr<const Type> named, Flags flags, size_t begin, TokenCursor cur, const ParseContext& ctx) {
+		// `HANDLE const` and `const HANDLE` are the same type
+		Flags flags_postfix;
+		if (auto result = Flags::Parse(cur)) {
+			flags_postfix = std::get<Flags>(result.GetOk());
+			cur = std::get<TokenCursor>(result.GetOk());
+		}
+		else
+			return ParseBaseTypeResult::Err{ result.GetErr() };
+
+		if (flags_postfix.bits & FLAGS_INT)
+			return ParseBaseTypeResult::Err{ ParseError(ErrorCode::InvalidSpecifiers, begin) };
+		if (flags.call_conv.has_value() && flags_postfix.call_conv.has_value())
+			return ParseBaseTypeResult::Err{ ParseError(ErrorCode::MultipleCallConventions, begin) };
+
+		flags.bits |= flags_postfix.bits;
+		if (!flags.call_conv.has_value())
+			flags.call_conv = flags_postfix.call_conv;
+
+		if (!flags.bits && !flags.call_conv.has_value())
+			return ParseBaseTypeResult::Ok{ std::pair(std::move(named), cur) };
+
+		// Qualify the typedef's own node, so `const PSTR` is a const pointer rather than a pointer to const
+		if (flags.call_conv.has_value() && named->m_flags.call_conv.has_value())
+			return ParseBaseTypeResult::Err{ ParseError(ErrorCode::MultipleCallConventions, begin) };
+
+		Type qualified = *named;
+		qualified.m_flags.bits |= flags.bits;
+		if (flags.call_conv.has_value())
+			qualified.m_flags.call_conv = flags.call_conv;
+		qualified.m_hash = qualified.ComputeHash();
+		return ParseBaseTypeResult::Ok{ std::pair(Make(ctx, std::move(qualified)), cur) };
+	}
+
+	Type::ParseBaseTypeResult Type::ParseBaseType(TokenCursor cur, TypeParseMask mask, const ParseContext& ctx) {
+		static constexpr std::array<SpecifierTables::PrimitiveRule, 16> rules = SpecifierTables::MakePrimitiveRules(FLAGS_INT, Flags::Long);
+		size_t begin = cur.Pos();
+
+		std::optional<Primitive> prim;
+		Flags flags;
+		if (auto result = Flags::Parse(cur, &prim)) {
+			flags = std::get<Flags>(result.GetOk());
+			cur = std::get<TokenCursor>(result.GetOk());
+		}
+		else
+			return ParseBaseTypeResult::Err{ result.GetErr() };
+
+		if (!prim.has_value()) {
+			if (flags.bits & FLAGS_INT)
+				prim = Primitive::Int; // Default to int if int-related flags are given
+			else if (std::shared_ptr<const Type> named = FindTypedef(cur, ctx)) {
+				cur.Skip();
+				return ParseNamedType(std::move(named), flags, begin, cur, ctx);
+			}
+			else if (cur.PeekClass(TokenSet(TokenId::Struct, TokenId::Union))) {
+				std::shared_ptr<const Type> record;
+				if (auto result = ParseRecord(cur, mask, ctx)) {
+					record = std::get<std::shared_ptr<const Type>>(result.GetOk());
+					cur = std::get<TokenCursor>(result.GetOk());
+				}
+				else
+					return result;
+				return ParseNamedType(std::move(record), flags, begin, cur, ctx);
+			}
+			else
+				return ParseBaseTypeResult::Err{ ParseError(ErrorCode::ExpectedPrimitive, cur.Pos(), 0, TokenClass::Primitive) };
+		}
+
+		const SpecifierTables::PrimitiveRule& rule = rules[(size_t)prim.value()];
+		if (flags.bits & FLAGS_INT & ~rule.allowed)
+			return ParseBaseTypeResult::Err{ ParseError(rule.err, begin) };
+
+		// MSVC allows `long float` to mean `double`
+		if (prim == Primitive::Float && flags.bits & Flags::Long) {
+			flags.bits &= ~Flags::Long;
+			prim = Primitive::Double;
+		}
+
+		return ParseBaseTypeResult::Ok{ std::pair(Make(ctx, Type(prim.value(), flags)), cur) };
+	}
+	Type::ParseResult Type::Parse(TokenCursor cur, TypeParseMask mask, const ParseContext& ctx) {
+		Stats::PhaseTimer timer = Stats::PhaseTimer(ParseStats::Parse);
+		std::shared_ptr<const Type> base_type;
+		if (auto result = ParseBaseType(cur, mask, ctx)) {
+			base_type = std::get<std::shared_ptr<const Type>>(result.GetOk());
+			cur = std::get<TokenCursor>(result.GetOk());
+		}
+		else
+			return ParseResult::Err{ result.GetErr() };
+
+		while (cur.Match(TokenId::Asterisk)) {
+			size_t begin = cur.Pos();
+
+			Flags flags;
+			if (auto result = Flags::Parse(cur)) {
+				flags = std::get<Flags>(result.GetOk());
+				cur = std::get<TokenCursor>(result.GetOk());
+			}
+			else
+				return ParseResult::Err{ result.GetErr() };
+
+			if (flags.bits & FLAGS_INT)
+				return ParseResult::Err{ ParseError(ErrorCode::IntSpecifiersOnPointer, begin) };
+
+			flags.bits |= Flags::Pointer;
+			base_type = Make(ctx, Type(std::move(base_type), flags));
+		}
+
+		return ParseResult::Ok{ std::pair(base_type, cur) };
+	}
+
+	Variable::ParseResult Variable::Parse(TokenCursor cur, TypeParseMask mask, const ParseContext& ctx) {
+		std::shared_ptr<const Type> type;
+		if (auto result = Type::Parse(cur, mask, ctx)) {
+			type = std::get<std::shared_ptr<const Type>>(result.GetOk());
+			cur = std::get<TokenCursor>(result.GetOk());
+		}
+		else
+			return ParseResult::Err{ result.GetErr() };
+
+		std::optional<Token> tk_name = cur.Match(TokenId::Identifier);
+		if (!tk_name)
+			return ParseResult::Err{ ParseError(ErrorCode::ExpectedIdentifier, cur.Pos(), 0, TokenSet(TokenId::Identifier)) };
+
+		return ParseResult::Ok{ std::pair(Variable(type, InternName(ctx, tk_name->view)), cur) };
+	}
+
+	Argument::ParseResult Argument::Parse(TokenCursor cur, const ParseContext& ctx) {
+		static const TypeParseMask mask = ParseMaskBlacklist(TypeParseMask::Structs);
+
+		if (cur.MatchSequence(TokenId::Period, TokenId::Period, TokenId::Period))
+			return ParseResult::Ok{ std::pair(Argument(), cur) };
+
+		std::shared_ptr<const Type> type;
+		if (auto result = Type::Parse(cur, mask, ctx)) {
+			type = std::get<std::shared_ptr<const Type>>(result.GetOk());
+			cur = std::get<TokenCursor>(result.GetOk());
+		}
+		else
+			return ParseResult::Err{ result.GetErr() };
+
+		if (std::optional<Token> tk_name = cur.Match(TokenId::Identifier)) {
+			Variable var = Variable(type, InternName(ctx, tk_name->view));
+			return ParseResult::Ok{ std::pair(Argument(std::move(var)), cur) };
+		}
+		else
+			return ParseResult::Ok{ std::pair(Argument(type), cur) };
+	}
+
+	FunctionProto::ParseResult FunctionProto::Parse(TokenCursor cur, const ParseContext& ctx) {
+		/*
+		TODO: Include calling conventions as a type specifier.
+		Variable::Parse() should scream if any calling convention is set
+		Argument::Parse() will use Variable::Parse(), propogating that check
+
+		This also begs the questions:
+		Should Type contain both 'name' and 'conv' attributes on its own?
+		Even if not, conv needs to be parsed by it. How would they be shared privately?
+		*/
+
+		Stats::PhaseTimer timer = Stats::PhaseTimer(ParseStats::Parse);
+		std::shared_ptr<const Type> ret_type;
+		if (auto result = Type::Parse(cur, ParseMaskBlacklist(), ctx)) {
+			ret_type = std::get<std::shared_ptr<const Type>>(result.GetOk());
+			cur = std::get<TokenCursor>(result.GetOk());
+		}
+		else
+			return ParseResult::Err{ result.GetErr() };
+
+		Name name;
+		if (std::optional<Token> tk_name = cur.Match(TokenId::Identifier))
+			name = InternName(ctx, tk_name->view);
+		else
+			return ParseResult::Err{ ParseError(ErrorCode::ExpectedIdentifier, cur.Pos(), 0, TokenSet(TokenId::Identifier)) };
+
+		if (!cur.Match(TokenId::Round_Open))
+			return ParseResult::Err{ ParseError(ErrorCode::ExpectedArguments, cur.Pos(), 0, TokenSet(TokenId::Round_Open)) };
+
+		ArenaVector<Argument> args = ArenaVector<Argument>(NodeArena(ctx));
+
+		// `()` and `(void)` both take no arguments
+		if (!cur.Match(TokenId::Round_Close) && !cur.MatchSequence(TokenId::Void, TokenId::Round_Close)) {
+			while (true) {
+				if (auto result = Argument::Parse(cur, ctx)) {
+					args.push_back(std::get<Argument>(result.GetOk()));
+					cur = std::get<TokenCursor>(result.GetOk());
+				}
+				else
+					return ParseResult::Err{ result.GetErr() };
+
+				if (cur.Match(TokenId::Round_Close))
+					break;
+				if (!cur.Match(TokenId::Comma))
+					return ParseResult::Err{ ParseError(ErrorCode::ExpectedArguments, cur.Pos(), 0, TokenSet(TokenId::Comma, TokenId::Round_Close)) };
+			}
+		}
+
+		return ParseResult::Ok{ std::pair(FunctionProto(name, ret_type, args), cur) };
+	}
 }
\ No newline at end of file
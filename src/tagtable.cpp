@@ -0,0 +1,17 @@
+#include <cdecl/c/tagtable.hpp>
+
+namespace Cdecl {
+	bool TagTable::Define(const std::shared_ptr<const Record>& record) {
+		if (m_records.Define(record->GetTag(), std::make_shared<const Type>(record)))
+			return true;
+
+		// The TypeTable compares records by identity, so an identical definition parsed again lands here
+		std::shared_ptr<const Record> existing = Find(record->GetTag());
+		return existing && *existing == *record;
+	}
+
+	std::shared_ptr<const Record> TagTable::Find(const string_view& tag) const {
+		std::shared_ptr<const Type> type = m_records.Find(tag);
+		return type ? type->GetRecord() : nullptr;
+	}
+}
\ No newline at end of file
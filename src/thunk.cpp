@@ -0,0 +1,217 @@
+#include <cdecl/c/thunk.hpp>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#define CDECL_HOST_SYSV_X64
+#include <sys/mman.h>
+#endif
+
+namespace Cdecl {
+	static constexpr size_t page_size = 4096;
+	static constexpr size_t trampoline_size = 128;
+	static constexpr size_t stub_size = 16;
+	static constexpr size_t stubs_per_page = (page_size - trampoline_size) / stub_size;
+
+	// Argument registers as the trampoline spills them
+	struct RegisterFrame {
+		uint64_t ints[6];
+		double vecs[8];
+	};
+
+	static void StoreArg(CallPlan::Load load, uint64_t value, unsigned char* dst) {
+		static constexpr uint32_t sizes[] = { 1, 1, 2, 2, 4, 4, 8, 4, 8 };
+		std::memcpy(dst, &value, sizes[(size_t)load]); // Little-endian, so the low bytes hold the value
+	}
+
+	uint64_t ThunkAllocator::Dispatch(const Context* ctx, void* registers, const uint64_t* stack) {
+		const CallPlan& plan = *ctx->plan;
+		RegisterFrame* frame = (RegisterFrame*)registers;
+
+		unsigned char local[256];
+		std::vector<unsigned char> heap;
+		unsigned char* args = local;
+		if (plan.args_size > sizeof(local)) {
+			heap.resize(plan.args_size);
+			args = heap.data();
+		}
+
+		for (const CallPlan::Step& step : plan.steps) {
+			uint64_t value;
+			switch (step.dest) {
+			case CallPlan::Dest::IntReg: value = frame->ints[step.index]; break;
+			case CallPlan::Dest::VecReg: std::memcpy(&value, &frame->vecs[step.index], sizeof(value)); break;
+			default: value = stack[step.index]; break;
+			}
+			StoreArg(step.load, value, args + step.src);
+		}
+
+		uint64_t ret = 0;
+		ctx->callback(args, &ret);
+
+		// The trampoline reloads xmm0 from the frame on the way out
+		if (plan.ret == CallPlan::Return::Float)
+			std::memcpy(&frame->vecs[0], &ret, sizeof(ret));
+		return ret;
+	}
+
+#ifdef CDECL_HOST_SYSV_X64
+	static size_t EmitTrampoline(unsigned char* code, uint64_t target) {
+		static const unsigned char prologue[] = {
+			0x55, // push rbp
+			0x48, 0x89, 0xE5, // mov rbp, rsp
+			0x48, 0x83, 0xEC, 0x70, // sub rsp, sizeof(RegisterFrame)
+			0x48, 0x89, 0x3C, 0x24, // mov [rsp], rdi
+			0x48, 0x89, 0x74, 0x24, 0x08, // mov [rsp+8], rsi
+			0x48, 0x89, 0x54, 0x24, 0x10, // mov [rsp+16], rdx
+			0x48, 0x89, 0x4C, 0x24, 0x18, // mov [rsp+24], rcx
+			0x4C, 0x89, 0x44, 0x24, 0x20, // mov [rsp+32], r8
+			0x4C, 0x89, 0x4C, 0x24, 0x28, // mov [rsp+40], r9
+			0xF2, 0x0F, 0x11, 0x44, 0x24, 0x30, // movsd [rsp+48], xmm0
+			0xF2, 0x0F, 0x11, 0x4C, 0x24, 0x38, // movsd [rsp+56], xmm1
+			0xF2, 0x0F, 0x11, 0x54, 0x24, 0x40, // movsd [rsp+64], xmm2
+			0xF2, 0x0F, 0x11, 0x5C, 0x24, 0x48, // movsd [rsp+72], xmm3
+			0xF2, 0x0F, 0x11, 0x64, 0x24, 0x50, // movsd [rsp+80], xmm4
+			0xF2, 0x0F, 0x11, 0x6C, 0x24, 0x58, // movsd [rsp+88], xmm5
+			0xF2, 0x0F, 0x11, 0x74, 0x24, 0x60, // movsd [rsp+96], xmm6
+			0xF2, 0x0F, 0x11, 0x7C, 0x24, 0x68, // movsd [rsp+104], xmm7
+			0x4C, 0x89, 0xD7, // mov rdi, r10
+			0x48, 0x89, 0xE6, // mov rsi, rsp
+			0x48, 0x8D, 0x55, 0x10, // lea rdx, [rbp+16]
+			0x48, 0xB8, // mov rax, imm64
+		};
+		static const unsigned char epilogue[] = {
+			0xFF, 0xD0, // call rax
+			0xF2, 0x0F, 0x10, 0x44, 0x24, 0x30, // movsd xmm0, [rsp+48]
+			0xC9, // leave
+			0xC3, // ret
+		};
+		static_assert(sizeof(RegisterFrame) == 0x70, "The trampoline's frame must match RegisterFrame");
+		static_assert(sizeof(prologue) + 8 + sizeof(epilogue) <= trampoline_size, "Trampoline doesn't fit");
+
+		size_t pos = 0;
+		std::memcpy(code + pos, prologue, sizeof(prologue)), pos += sizeof(prologue);
+		std::memcpy(code + pos, &target, sizeof(target)), pos += sizeof(target);
+		std::memcpy(code + pos, epilogue, sizeof(epilogue)), pos += sizeof(epilogue);
+		return pos;
+	}
+
+	// mov r10, [rip + context]; jmp trampoline
+	static void EmitStub(unsigned char* stub, const unsigned char* trampoline, const void* context_slot) {
+		int32_t context_rel = (int32_t)((const unsigned char*)context_slot - (stub + 7));
+		int32_t jump_rel = (int32_t)(trampoline - (stub + 12));
+
+		stub[0] = 0x4C, stub[1] = 0x8B, stub[2] = 0x15;
+		std::memcpy(stub + 3, &context_rel, 4);
+		stub[7] = 0xE9;
+		std::memcpy(stub + 8, &jump_rel, 4);
+		std::memset(stub + 12, 0xCC, stub_size - 12); // int3
+	}
+#endif
+
+	std::optional<string> ThunkAllocator::MapPage() {
+#ifdef CDECL_HOST_SYSV_X64
+		void* mapping = mmap(nullptr, page_size * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (mapping == MAP_FAILED)
+			return Format("Failed to map thunk pages (errno ", errno, ')').str();
+
+		Page page;
+		page.code = (unsigned char*)mapping;
+		page.contexts = (Context**)(page.code + page_size);
+		page.owned.resize(stubs_per_page);
+
+		std::memset(page.code, 0xCC, page_size);
+		EmitTrampoline(page.code, (uint64_t)&Dispatch);
+		for (size_t i = 0; i < stubs_per_page; ++i)
+			EmitStub(page.code + trampoline_size + i * stub_size, page.code, &page.contexts[i]);
+
+		if (mprotect(page.code, page_size, PROT_READ | PROT_EXEC) != 0) {
+			munmap(mapping, page_size * 2);
+			return Format("Failed to make thunk page executable (errno ", errno, ')').str();
+		}
+
+		// Hand out the lowest slot first
+		for (size_t i = stubs_per_page; i > 0; --i)
+			m_free.push_back((Thunk)(page.code + trampoline_size + (i - 1) * stub_size));
+		m_pages.push_back(std::move(page));
+		return {};
+#else
+		return string("Thunks are only supported on x86-64 SysV hosts");
+#endif
+	}
+
+	std::shared_ptr<const CallPlan> ThunkAllocator::GetPlan(CallPlan&& plan) {
+		// Plans with the same moves behave identically, whatever prototype they came from
+		string key;
+		key.append((const char*)&plan.ret, sizeof(plan.ret));
+		key.append((const char*)&plan.ret_size, sizeof(plan.ret_size));
+		for (const CallPlan::Step& step : plan.steps)
+			key.append((const char*)&step, sizeof(step));
+
+		std::shared_ptr<const CallPlan>& shared = m_plans[key];
+		if (!shared)
+			shared = std::make_shared<const CallPlan>(std::move(plan));
+		return shared;
+	}
+
+	ThunkAllocator::~ThunkAllocator() {
+#ifdef CDECL_HOST_SYSV_X64
+		for (Page& page : m_pages)
+			munmap(page.code, page_size * 2);
+#endif
+	}
+
+	ThunkAllocator::CreateResult ThunkAllocator::Create(const FunctionProto& proto, Callback callback) {
+		CompileCallPlanResult compiled = CompileCallPlan(proto, Abi::SysV_x64);
+		if (!compiled)
+			return CreateResult::Err{ compiled.GetErr() };
+
+		std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(m_mutex);
+
+		if (m_free.empty()) {
+			if (std::optional<string> err = MapPage())
+				return CreateResult::Err{ err.value() };
+		}
+
+		Thunk thunk = m_free.back();
+		m_free.pop_back();
+
+		for (Page& page : m_pages) {
+			size_t offset = (unsigned char*)thunk - page.code;
+			if (offset >= page_size)
+				continue;
+
+			size_t index = (offset - trampoline_size) / stub_size;
+			page.owned[index].reset(new Context{ GetPlan(CallPlan(compiled.GetOk())), std::move(callback) });
+			page.contexts[index] = page.owned[index].get();
+			break;
+		}
+
+		++m_live;
+		return CreateResult::Ok{ thunk };
+	}
+
+	void ThunkAllocator::Free(Thunk thunk) {
+		std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(m_mutex);
+
+		for (Page& page : m_pages) {
+			size_t offset = (unsigned char*)thunk - page.code;
+			if (offset < trampoline_size || offset >= page_size)
+				continue;
+
+			size_t index = (offset - trampoline_size) / stub_size;
+			if (!page.owned[index])
+				return;
+			page.contexts[index] = nullptr;
+			page.owned[index].reset();
+			m_free.push_back(thunk);
+			--m_live;
+			return;
+		}
+	}
+
+	size_t ThunkAllocator::Size() {
+		std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(m_mutex);
+		return m_live;
+	}
+}
\ No newline at end of file
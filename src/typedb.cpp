@@ -0,0 +1,458 @@
+#include <cdecl/c/typedb.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "TypeDbFormat is little-endian and read in place, so big-endian hosts are unsupported"
+#endif
+
+namespace Cdecl {
+	using namespace TypeDbFormat;
+
+	// Tags a node kind in dedup keys, and lists the Refs to convert to relative offsets when it is written
+	template <class TNode>
+	struct NodeTraits;
+
+	template <>
+	struct NodeTraits<TypeNode> {
+		static constexpr char tag = 'T';
+		static constexpr size_t refs[] = { offsetof(TypeNode, decl) + offsetof(String, data), offsetof(TypeNode, base) };
+	};
+
+	template <>
+	struct NodeTraits<ArgNode> {
+		static constexpr char tag = 'A';
+		static constexpr size_t refs[] = { offsetof(ArgNode, type), offsetof(ArgNode, name) + offsetof(String, data) };
+	};
+
+	template <>
+	struct NodeTraits<ProtoNode> {
+		static constexpr char tag = 'P';
+		static constexpr size_t refs[] = { offsetof(ProtoNode, name) + offsetof(String, data), offsetof(ProtoNode, ret), offsetof(ProtoNode, args) };
+	};
+
+	template <>
+	struct NodeTraits<MemberNode> {
+		static constexpr char tag = 'M';
+		static constexpr size_t refs[] = { offsetof(MemberNode, type), offsetof(MemberNode, name) + offsetof(String, data) };
+	};
+
+	template <>
+	struct NodeTraits<RecordNode> {
+		static constexpr char tag = 'R';
+		static constexpr size_t refs[] = { offsetof(RecordNode, tag) + offsetof(String, data), offsetof(RecordNode, members) };
+	};
+
+	static uint64_t Fnv1a(uint64_t hash, const unsigned char* data, size_t size) {
+		for (size_t i = 0; i < size; ++i)
+			hash = (hash ^ data[i]) * 0x100000001b3ull;
+		return hash;
+	}
+
+	uint64_t TypeDbFormat::Checksum(const unsigned char* data, size_t size) {
+		static constexpr unsigned char zeroed[sizeof(Header::checksum)] = {};
+		static constexpr size_t field = offsetof(Header, checksum);
+
+		uint64_t hash = Fnv1a(0xcbf29ce484222325ull, data, field);
+		hash = Fnv1a(hash, zeroed, sizeof(zeroed));
+		return Fnv1a(hash, data + field + sizeof(zeroed), size - field - sizeof(zeroed));
+	}
+
+	/*
+	 * Walks every node reachable from the proto table and checks that each Ref and String lands inside the file,
+	 * aligned and with room for what it points at. Shared nodes are visited once, and the walk uses no recursion.
+	 */
+	class RefChecker {
+		const unsigned char* m_data;
+		size_t m_size;
+		std::vector<uint8_t> m_visited; // Per 4-byte slot, a bit per kind of node checked there
+		std::vector<const TypeNode*> m_types;
+		std::vector<const ProtoNode*> m_protos;
+		std::vector<const RecordNode*> m_records;
+
+		bool Check(const String& str) const {
+			const char_t* chars;
+			return Required(str.data, str.length, chars);
+		}
+
+		template <class T>
+		void Push(std::vector<const T*>& pending, const T* node) {
+			static_assert(alignof(T) == 4, "Nodes are visited by 4-byte slot");
+			uint8_t bit = std::is_same<T, TypeNode>::value ? 1 : std::is_same<T, ProtoNode>::value ? 2 : 4;
+			uint8_t& visited = m_visited[((const unsigned char*)node - m_data) / 4];
+			if (!(visited & bit)) {
+				visited |= bit;
+				pending.push_back(node);
+			}
+		}
+
+		bool CheckType(const TypeNode* node) {
+			if (node->has_decl && !Check(node->decl))
+				return false;
+
+			switch (node->kind) {
+			case TypeKind::Primitive:
+				return true;
+			case TypeKind::Pointee: {
+				const TypeNode* base;
+				if (!Required(node->base, 1, base))
+					return false;
+				Push(m_types, base);
+				return true;
+			}
+			case TypeKind::Proto: {
+				const ProtoNode* base;
+				if (!Required(node->base, 1, base))
+					return false;
+				Push(m_protos, base);
+				return true;
+			}
+			case TypeKind::Record: {
+				const RecordNode* base;
+				if (!Required(node->base, 1, base))
+					return false;
+				Push(m_records, base);
+				return true;
+			}
+			default:
+				return false;
+			}
+		}
+
+		bool CheckProto(const ProtoNode* node) {
+			const TypeNode* ret;
+			const ArgNode* args;
+			if (!Check(node->name) || !Required(node->ret, 1, ret) || !Required(node->args, node->arg_count, args))
+				return false;
+			Push(m_types, ret);
+
+			for (size_t i = 0; i < node->arg_count; ++i) {
+				if (args[i].kind == ArgKind::Variadic)
+					continue;
+				if (args[i].kind != ArgKind::Type && args[i].kind != ArgKind::Variable)
+					return false;
+
+				const TypeNode* type;
+				if (!Required(args[i].type, 1, type) || !Check(args[i].name))
+					return false;
+				Push(m_types, type);
+			}
+			return true;
+		}
+
+		bool CheckRecord(const RecordNode* node) {
+			const MemberNode* members;
+			if (!Check(node->tag) || !Required(node->members, node->member_count, members))
+				return false;
+
+			for (size_t i = 0; i < node->member_count; ++i) {
+				const TypeNode* type;
+				if (!Required(members[i].type, 1, type) || !Check(members[i].name))
+					return false;
+				Push(m_types, type);
+			}
+			return true;
+		}
+
+	public:
+		RefChecker(const unsigned char* data, size_t size) : m_data(data), m_size(size) {}
+
+		// Null refs are in bounds, and leave `target` null
+		template <class T>
+		bool Target(const Ref& ref, size_t count, const T*& target) const {
+			target = nullptr;
+			if (ref.rel == 0)
+				return true;
+
+			ptrdiff_t pos = ((const unsigned char*)&ref - m_data) + ref.rel;
+			if (pos < (ptrdiff_t)sizeof(Header) || (size_t)pos > m_size || (size_t)pos % alignof(T) != 0)
+				return false;
+			if (count > (m_size - (size_t)pos) / sizeof(T))
+				return false;
+			target = (const T*)(m_data + pos);
+			return true;
+		}
+
+		// Like Target, but null is only allowed for an empty array
+		template <class T>
+		bool Required(const Ref& ref, size_t count, const T*& target) const {
+			return Target(ref, count, target) && (target || count == 0);
+		}
+
+		// The proto table itself must already be in bounds
+		bool Check(const Ref* protos, size_t count) {
+			m_visited.assign(m_size / 4, 0);
+			for (size_t i = 0; i < count; ++i) {
+				const ProtoNode* proto;
+				if (!Required(protos[i], 1, proto))
+					return false;
+				Push(m_protos, proto);
+			}
+
+			while (!m_types.empty() || !m_protos.empty() || !m_records.empty()) {
+				if (!m_types.empty()) {
+					const TypeNode* node = m_types.back();
+					m_types.pop_back();
+					if (!CheckType(node))
+						return false;
+				}
+				else if (!m_protos.empty()) {
+					const ProtoNode* node = m_protos.back();
+					m_protos.pop_back();
+					if (!CheckProto(node))
+						return false;
+				}
+				else {
+					const RecordNode* node = m_records.back();
+					m_records.pop_back();
+					if (!CheckRecord(node))
+						return false;
+				}
+			}
+			return true;
+		}
+	};
+
+	TypeDbWriter::TypeDbWriter() {
+		m_data.resize(sizeof(Header));
+	}
+
+	template <class TNode>
+	uint32_t TypeDbWriter::Emit(const TNode* nodes, size_t count) {
+		if (count == 0)
+			return 0;
+
+		std::string key = std::string(1, NodeTraits<TNode>::tag);
+		key.append((const char*)nodes, sizeof(TNode) * count);
+		auto it = m_nodes.find(key);
+		if (it != m_nodes.end())
+			return it->second;
+
+		m_data.resize((m_data.size() + 3) / 4 * 4);
+		uint32_t pos = (uint32_t)m_data.size();
+		m_data.insert(m_data.end(), (const unsigned char*)nodes, (const unsigned char*)(nodes + count));
+
+		for (size_t i = 0; i < count; ++i) {
+			for (size_t field : NodeTraits<TNode>::refs) {
+				uint32_t field_pos = pos + (uint32_t)(i * sizeof(TNode) + field);
+				Ref ref;
+				std::memcpy(&ref, &m_data[field_pos], sizeof(ref));
+				if (ref.rel != 0)
+					ref.rel -= (int32_t)field_pos;
+				std::memcpy(&m_data[field_pos], &ref, sizeof(ref));
+			}
+		}
+
+		m_nodes.emplace(std::move(key), pos);
+		return pos;
+	}
+
+	String TypeDbWriter::WriteString(string_view str) {
+		if (str.empty())
+			return String{ Ref{ 0 }, 0 };
+
+		auto it = m_strings.find(string(str));
+		if (it != m_strings.end())
+			return String{ Ref{ (int32_t)it->second }, (uint32_t)str.length() };
+
+		m_data.resize((m_data.size() + alignof(char_t) - 1) / alignof(char_t) * alignof(char_t));
+		uint32_t pos = (uint32_t)m_data.size();
+		m_data.insert(m_data.end(), (const unsigned char*)str.data(), (const unsigned char*)(str.data() + str.length()));
+		m_strings.emplace(string(str), pos);
+		return String{ Ref{ (int32_t)pos }, (uint32_t)str.length() };
+	}
+
+	uint32_t TypeDbWriter::WriteType(const Type& type) {
+		static_assert((uint32_t)TypeFlags::Pointer == (uint32_t)Type::Flags::Pointer && (uint32_t)TypeFlags::Short == (uint32_t)Type::Flags::Short, "TypeDbFormat flags must match Type's");
+
+		TypeNode node = {};
+		if (type.IsPrimitive()) {
+			node.kind = TypeKind::Primitive;
+			node.primitive = (uint32_t)type.GetPrimitiveType();
+		}
+		else if (type.IsFunctionProto()) {
+			node.kind = TypeKind::Proto;
+			node.base.rel = (int32_t)WriteProto(*type.GetFunctionProto());
+		}
+		else if (type.IsRecord()) {
+			node.kind = TypeKind::Record;
+			node.base.rel = (int32_t)WriteRecord(*type.GetRecord());
+		}
+		else {
+			node.kind = TypeKind::Pointee;
+			node.base.rel = (int32_t)WriteType(*type.GetPointedType());
+		}
+
+		node.flags = type.m_flags.bits;
+		node.call_conv = type.m_flags.call_conv.has_value() ? (uint8_t)type.m_flags.call_conv.value() : no_call_conv;
+		if (type.m_decl.has_value()) {
+			node.has_decl = 1;
+			node.decl = WriteString(type.m_decl.value());
+		}
+
+		size_t before = m_nodes.size();
+		uint32_t pos = Emit(&node, 1);
+		if (m_nodes.size() != before)
+			++m_type_count;
+		return pos;
+	}
+
+	ArgNode TypeDbWriter::MakeArg(const Argument& arg) {
+		ArgNode node = {};
+		if (arg.IsVariadic())
+			node.kind = ArgKind::Variadic;
+		else if (arg.IsType()) {
+			node.kind = ArgKind::Type;
+			node.type.rel = (int32_t)WriteType(*arg.GetType());
+		}
+		else {
+			node.kind = ArgKind::Variable;
+			node.type.rel = (int32_t)WriteType(*arg.GetVar().GetType());
+			node.name = WriteString(arg.GetVar().GetName());
+		}
+		return node;
+	}
+
+	uint32_t TypeDbWriter::WriteProto(const FunctionProto& proto) {
+		// Children go first, so the nodes of each array end up contiguous
+		std::vector<ArgNode> args;
+		args.reserve(proto.GetArgs().size());
+		for (const Argument& arg : proto.GetArgs())
+			args.push_back(MakeArg(arg));
+
+		ProtoNode node = {};
+		node.name = WriteString(proto.GetName());
+		node.ret.rel = (int32_t)WriteType(*proto.GetReturnType());
+		node.arg_count = (uint32_t)args.size();
+		node.args.rel = (int32_t)Emit(args.data(), args.size());
+		return Emit(&node, 1);
+	}
+
+	uint32_t TypeDbWriter::WriteRecord(const Record& record) {
+		std::vector<MemberNode> members;
+		members.reserve(record.GetMembers().size());
+		for (const Variable& member : record.GetMembers())
+			members.push_back(MemberNode{ Ref{ (int32_t)WriteType(*member.GetType()) }, WriteString(member.GetName()) });
+
+		RecordNode node = {};
+		node.tag = WriteString(record.GetTag());
+		node.is_union = record.IsUnion();
+		node.complete = record.IsComplete();
+		node.pack = record.GetPack();
+		node.member_count = (uint32_t)members.size();
+		node.members.rel = (int32_t)Emit(members.data(), members.size());
+		return Emit(&node, 1);
+	}
+
+	void TypeDbWriter::Add(const FunctionProto& proto) {
+		uint32_t pos = WriteProto(proto);
+		m_protos.emplace_back(string(proto.GetName()), pos);
+	}
+
+	std::vector<unsigned char> TypeDbWriter::Finish() {
+		std::stable_sort(m_protos.begin(), m_protos.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+		m_data.resize((m_data.size() + 3) / 4 * 4);
+		uint32_t table = (uint32_t)m_data.size();
+		for (size_t i = 0; i < m_protos.size(); ++i) {
+			Ref ref = Ref{ (int32_t)m_protos[i].second - (int32_t)(table + i * sizeof(Ref)) };
+			m_data.insert(m_data.end(), (const unsigned char*)&ref, (const unsigned char*)(&ref + 1));
+		}
+
+		Header header = {};
+		std::memcpy(header.magic, magic, sizeof(magic));
+		header.version = version;
+		header.char_size = sizeof(char_t);
+		header.size = m_data.size();
+		header.type_count = m_type_count;
+		header.proto_count = (uint32_t)m_protos.size();
+		header.protos.rel = m_protos.empty() ? 0 : (int32_t)(table - offsetof(Header, protos));
+		std::memcpy(m_data.data(), &header, sizeof(header));
+		header.checksum = Checksum(m_data.data(), m_data.size());
+		std::memcpy(m_data.data() + offsetof(Header, checksum), &header.checksum, sizeof(header.checksum));
+
+		std::vector<unsigned char> data = std::move(m_data);
+		m_data.assign(sizeof(Header), 0);
+		m_strings.clear();
+		m_nodes.clear();
+		m_protos.clear();
+		m_type_count = 0;
+		return data;
+	}
+
+	std::optional<string> TypeDbWriter::Save(const char* path) {
+		std::vector<unsigned char> data = Finish();
+
+		FILE* file = std::fopen(path, "wb");
+		if (!file)
+			return Format("Failed to open \"", path, "\": ", std::strerror(errno)).str();
+
+		bool written = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+		if (std::fclose(file) != 0 || !written)
+			return Format("Failed to write \"", path, "\": ", std::strerror(errno)).str();
+		return {};
+	}
+
+	TypeDb::OpenResult TypeDb::Validate(std::shared_ptr<TypeDb> db, const unsigned char* data, size_t size, bool verify) {
+		if (size < sizeof(Header) || std::memcmp(data, magic, sizeof(magic)) != 0)
+			return OpenResult::Err{ "Not a type database" };
+		if ((uintptr_t)data % 4 != 0)
+			return OpenResult::Err{ "Type database must be 4-byte aligned in memory" };
+
+		const Header* header = (const Header*)data;
+		if (header->version != version)
+			return OpenResult::Err{ Format("Type database version ", header->version, " is unsupported (expected ", version, ')').str() };
+		if (header->char_size != sizeof(char_t))
+			return OpenResult::Err{ "Type database was written with a different char_t" };
+		if (header->size != size)
+			return OpenResult::Err{ "Type database is truncated" };
+		if (verify && header->checksum != Checksum(data, size))
+			return OpenResult::Err{ "Type database checksum mismatch" };
+
+		const Ref* protos;
+		RefChecker checker = RefChecker(data, size);
+		if (!checker.Required(header->protos, header->proto_count, protos))
+			return OpenResult::Err{ "Type database proto table is out of bounds" };
+		if (verify && !checker.Check(protos, header->proto_count))
+			return OpenResult::Err{ "Type database has a reference out of bounds" };
+
+		db->m_header = header;
+		db->m_protos = protos;
+		return OpenResult::Ok{ db };
+	}
+
+	TypeDb::OpenResult TypeDb::Open(const char* path, bool verify) {
+		MappedFile::OpenResult file = MappedFile::Open(path);
+		if (!file)
+			return OpenResult::Err{ file.GetErr() };
+
+		std::shared_ptr<TypeDb> db = std::shared_ptr<TypeDb>(new TypeDb());
+		db->m_file = file.GetOk();
+		return Validate(db, (const unsigned char*)db->m_file->View().data(), db->m_file->SizeInBytes(), verify);
+	}
+
+	TypeDb::OpenResult TypeDb::Load(std::vector<unsigned char>&& data, bool verify) {
+		std::shared_ptr<TypeDb> db = std::shared_ptr<TypeDb>(new TypeDb());
+		db->m_owned = std::move(data);
+		return Validate(db, db->m_owned.data(), db->m_owned.size(), verify);
+	}
+
+	std::optional<TypeDb::ProtoView> TypeDb::FindProto(string_view name) const {
+		size_t lo = 0, hi = ProtoCount();
+		while (lo < hi) {
+			size_t mid = lo + (hi - lo) / 2;
+			if (GetProto(mid).GetName() < name)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+		if (lo < ProtoCount() && GetProto(lo).GetName() == name)
+			return GetProto(lo);
+		return {};
+	}
+}
\ No newline at end of file
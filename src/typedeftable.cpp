@@ -0,0 +1,92 @@
+#include <cdecl/c/typedeftable.hpp>
+
+namespace Cdecl {
+	TypedefTable::TypedefTable(size_t capacity) {
+		size_t slot_count = 16;
+		while (slot_count < capacity * 2)
+			slot_count *= 2;
+		Publish(slot_count);
+	}
+
+	// Builds a table with every entry so far and swaps it in. Must hold m_write_mutex, except from the constructor.
+	void TypedefTable::Publish(size_t slot_count) {
+		std::unique_ptr<Table> table = std::unique_ptr<Table>(new Table{ slot_count - 1, nullptr });
+		table->slots.reset(new std::atomic<const Entry*>[slot_count]);
+		for (size_t i = 0; i < slot_count; ++i)
+			table->slots[i].store(nullptr, std::memory_order_relaxed);
+
+		for (const Entry& entry : m_entries) {
+			size_t i = entry.hash & table->mask;
+			while (table->slots[i].load(std::memory_order_relaxed))
+				i = (i + 1) & table->mask;
+			table->slots[i].store(&entry, std::memory_order_relaxed);
+		}
+
+		m_table.store(table.get(), std::memory_order_release);
+		m_tables.push_back(std::move(table));
+	}
+
+	bool TypedefTable::Define(const string_view& name, const std::shared_ptr<const Type>& type) {
+		std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(m_write_mutex);
+
+		std::shared_ptr<const Type> canonical = m_types.Intern(type);
+		if (std::shared_ptr<const Type> existing = Find(name))
+			return existing == canonical;
+
+		m_entries.push_back(Entry{ m_types.GetStrings().Intern(name), Hash(name), canonical });
+
+		// Stay at most half full so probes stay short and always reach an empty slot
+		const Table* table = m_table.load(std::memory_order_relaxed);
+		if (m_entries.size() * 2 > table->mask + 1)
+			Publish((table->mask + 1) * 2);
+		else {
+			size_t i = m_entries.back().hash & table->mask;
+			while (table->slots[i].load(std::memory_order_relaxed))
+				i = (i + 1) & table->mask;
+			table->slots[i].store(&m_entries.back(), std::memory_order_release);
+		}
+
+		++m_count;
+		return true;
+	}
+
+	std::shared_ptr<const Type> TypedefTable::Find(const string_view& name) const {
+		const Table* table = m_table.load(std::memory_order_acquire);
+		size_t hash = Hash(name);
+
+		for (size_t i = hash & table->mask;; i = (i + 1) & table->mask) {
+			const Entry* entry = table->slots[i].load(std::memory_order_acquire);
+			if (!entry)
+				return nullptr;
+			if (entry->hash == hash && entry->name == name)
+				return entry->type;
+		}
+	}
+
+	TypedefTable::ParseResult TypedefTable::ParseTypedef(TokenCursor cur, const ParseContext& ctx) {
+		if (!cur.Match(TokenId::Typedef))
+			return ParseResult::Err{ ParseError(ErrorCode::ExpectedTypedef, cur.Pos(), 0, TokenSet(TokenId::Typedef)) };
+
+		ParseContext table_ctx = ctx;
+		if (!table_ctx.types)
+			table_ctx.types = &m_types;
+
+		std::shared_ptr<const Type> type;
+		if (auto result = Type::Parse(cur, ParseMaskBlacklist(), table_ctx)) {
+			type = std::get<std::shared_ptr<const Type>>(result.GetOk());
+			cur = std::get<TokenCursor>(result.GetOk());
+		}
+		else
+			return ParseResult::Err{ result.GetErr() };
+
+		size_t name_pos = cur.Pos();
+		std::optional<Token> tk_name = cur.Match(TokenId::Identifier);
+		if (!tk_name)
+			return ParseResult::Err{ ParseError(ErrorCode::ExpectedIdentifier, name_pos, 0, TokenSet(TokenId::Identifier)) };
+
+		if (!Define(tk_name->view, type))
+			return ParseResult::Err{ ParseError(ErrorCode::TypedefRedefinition, name_pos) };
+
+		return ParseResult::Ok{ std::pair(m_types.GetStrings().Intern(tk_name->view), cur) };
+	}
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include <cdecl/c/typetable.hpp>
+#include <cdecl/parsestats.hpp>
+#include <functional>
+
+namespace Cdecl {
+	size_t TypeTable::Hash(const Type& type) {
+		return type.Hash();
+	}
+
+	bool TypeTable::Equal(const Type& a, const Type& b) {
+		if (a.Hash() != b.Hash() || a.m_base.index() != b.m_base.index())
+			return false;
+
+		if (a.IsPrimitive()) {
+			if (a.GetPrimitiveType() != b.GetPrimitiveType())
+				return false;
+		}
+		else if (a.IsFunctionProto()) {
+			if (a.GetFunctionProto() != b.GetFunctionProto())
+				return false;
+		}
+		else if (a.IsRecord()) {
+			if (a.GetRecord() != b.GetRecord())
+				return false;
+		}
+		else if (a.GetPointedType() != b.GetPointedType())
+			return false;
+
+		return a.m_flags.bits == b.m_flags.bits
+			&& a.m_flags.call_conv == b.m_flags.call_conv
+			&& a.m_decl == b.m_decl;
+	}
+
+	TypeTable::typeid_t TypeTable::InternId(Type&& type) {
+		size_t shard_index = Hash(type) % shard_count;
+		Shard& shard = m_shards[shard_index];
+		std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(shard.mutex);
+
+		auto it = shard.index.find(&type);
+		if (it != shard.index.end())
+			return it->second;
+
+		typeid_t id = (typeid_t)(shard.nodes.size() * shard_count + shard_index);
+		Stats::Count(&ParseStats::allocations);
+		shard.nodes.push_back(std::make_shared<const Type>(std::move(type)));
+		shard.index.emplace(shard.nodes.back().get(), id);
+		return id;
+	}
+
+	std::shared_ptr<const Type> TypeTable::Intern(Type&& type) {
+		return Get(InternId(std::move(type)));
+	}
+
+	std::shared_ptr<const Type> TypeTable::Intern(const std::shared_ptr<const Type>& type) {
+		if (std::optional<typeid_t> id = GetId(*type))
+			return Get(id.value());
+
+		Type copy = *type;
+		if (!copy.IsPrimitive() && !copy.IsFunctionProto() && !copy.IsRecord())
+			copy.m_base = Intern(copy.GetPointedType());
+		return Intern(std::move(copy));
+	}
+
+	std::optional<TypeTable::typeid_t> TypeTable::GetId(const Type& type) {
+		Shard& shard = m_shards[Hash(type) % shard_count];
+		std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(shard.mutex);
+
+		auto it = shard.index.find(&type);
+		if (it == shard.index.end())
+			return {};
+		return it->second;
+	}
+
+	std::shared_ptr<const Type> TypeTable::Get(typeid_t id) {
+		Shard& shard = m_shards[id % shard_count];
+		std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(shard.mutex);
+
+		size_t index = id / shard_count;
+		if (index >= shard.nodes.size())
+			return nullptr;
+		return shard.nodes[index];
+	}
+
+	size_t TypeTable::Size() {
+		size_t size = 0;
+		for (Shard& shard : m_shards) {
+			std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(shard.mutex);
+			size += shard.nodes.size();
+		}
+		return size;
+	}
+}
\ No newline at end of file
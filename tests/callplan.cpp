@@ -0,0 +1,189 @@
+#include <cdecl/c/callplan.hpp>
+#include <cstring>
+#include "check.hpp"
+
+using namespace Cdecl;
+using namespace Cdecl::Test;
+
+// Packs arguments at the plan's offsets, in argument order
+class ArgPacker {
+	const CallPlan& m_plan;
+	std::vector<unsigned char> m_buffer;
+	size_t m_next = 0;
+
+public:
+	ArgPacker(const CallPlan& plan) : m_plan(plan), m_buffer(plan.args_size) {}
+
+	template <class T>
+	ArgPacker& operator<<(T value) {
+		CHECK(m_next < m_plan.arg_offsets.size());
+		CHECK(sizeof(T) == load_size(m_plan.steps[m_next].load));
+		std::memcpy(m_buffer.data() + m_plan.arg_offsets[m_next++], &value, sizeof(T));
+		return *this;
+	}
+
+	const void* Data() const { return m_buffer.data(); }
+
+	static size_t load_size(CallPlan::Load load) {
+		static constexpr size_t sizes[] = { 1, 1, 2, 2, 4, 4, 8, 4, 8 };
+		return sizes[(size_t)load];
+	}
+};
+
+extern "C" {
+	static int64_t SumInts(int64_t a, int64_t b, int64_t c, int64_t d, int64_t e, int64_t f, int64_t g, int64_t h) {
+		return a + 2 * b + 3 * c + 4 * d + 5 * e + 6 * f + 7 * g + 8 * h;
+	}
+
+	static double SumDoubles(double a, double b, double c, double d, double e, double f, double g, double h, double i, double j) {
+		return a + 2 * b + 3 * c + 4 * d + 5 * e + 6 * f + 7 * g + 8 * h + 9 * i + 10 * j;
+	}
+
+	static double Mixed(char a, float b, uint16_t c, double d, int8_t e, float f, int32_t g) {
+		return a * 1e6 + b * 1e4 + c + d / 10 + e * 1e-3 + f * 1e-5 + g * 1e8;
+	}
+
+	static float Halve(float x) { return x / 2; }
+	static int16_t Negate(int16_t x) { return (int16_t)-x; }
+}
+
+static void TestRegisterOverflow() {
+	CallPlan plan = CompileCallPlan(
+		ParseProto("int64_t SumInts(int64_t a, int64_t b, int64_t c, int64_t d, int64_t e, int64_t f, int64_t g, int64_t h)"), Abi::SysV_x64
+	).GetOk();
+	CHECK(plan.int_regs_used == 6);
+	CHECK(plan.stack_slots == 2);
+	CHECK(plan.steps[5].dest == CallPlan::Dest::IntReg && plan.steps[5].index == 5);
+	CHECK(plan.steps[6].dest == CallPlan::Dest::Stack && plan.steps[6].index == 0);
+	CHECK(plan.steps[7].dest == CallPlan::Dest::Stack && plan.steps[7].index == 1);
+
+	CallPlan doubles = CompileCallPlan(
+		ParseProto("double SumDoubles(double a, double b, double c, double d, double e, double f, double g, double h, double i, double j)"), Abi::SysV_x64
+	).GetOk();
+	CHECK(doubles.vec_regs_used == 8);
+	CHECK(doubles.int_regs_used == 0);
+	CHECK(doubles.stack_slots == 2);
+
+	if (CanInvoke(plan)) {
+		ArgPacker args(plan);
+		for (int64_t i = 1; i <= 8; ++i)
+			args << i * 1000;
+		int64_t ret = 0;
+		CHECK(Invoke(plan, (void (*)())&SumInts, args.Data(), &ret));
+		CHECK(ret == SumInts(1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000));
+
+		ArgPacker double_args(doubles);
+		for (int i = 1; i <= 10; ++i)
+			double_args << i + 0.25;
+		double double_ret = 0;
+		CHECK(Invoke(doubles, (void (*)())&SumDoubles, double_args.Data(), &double_ret));
+		CHECK(double_ret == SumDoubles(1.25, 2.25, 3.25, 4.25, 5.25, 6.25, 7.25, 8.25, 9.25, 10.25));
+	}
+}
+
+static void TestMixedArgs() {
+	CallPlan plan = CompileCallPlan(
+		ParseProto("double Mixed(char a, float b, uint16_t c, double d, int8_t e, float f, int32_t g)"), Abi::SysV_x64
+	).GetOk();
+	CHECK(plan.int_regs_used == 4);
+	CHECK(plan.vec_regs_used == 3);
+	CHECK(plan.steps[1].load == CallPlan::Load::F32); // Named floats stay floats
+	CHECK(plan.steps[2].load == CallPlan::Load::U16);
+
+	if (CanInvoke(plan)) {
+		ArgPacker args(plan);
+		args << (char)-3 << 1.5f << (uint16_t)60000 << 2.5 << (int8_t)-9 << 0.75f << (int32_t)-7;
+		double ret = 0;
+		CHECK(Invoke(plan, (void (*)())&Mixed, args.Data(), &ret));
+		CHECK(ret == Mixed(-3, 1.5f, 60000, 2.5, -9, 0.75f, -7));
+	}
+
+	CallPlan halve = CompileCallPlan(ParseProto("float Halve(float x)"), Abi::SysV_x64).GetOk();
+	CHECK(halve.ret == CallPlan::Return::Float && halve.ret_size == 4);
+	CallPlan negate = CompileCallPlan(ParseProto("int16_t Negate(int16_t x)"), Abi::SysV_x64).GetOk();
+	CHECK(negate.ret == CallPlan::Return::Int && negate.ret_size == 2);
+
+	if (CanInvoke(halve)) {
+		ArgPacker args(halve);
+		args << 3.0f;
+		float ret = 0;
+		CHECK(Invoke(halve, (void (*)())&Halve, args.Data(), &ret));
+		CHECK(ret == 1.5f);
+	}
+	if (CanInvoke(negate)) {
+		ArgPacker args(negate);
+		args << (int16_t)-12;
+		int16_t ret = 0;
+		CHECK(Invoke(negate, (void (*)())&Negate, args.Data(), &ret));
+		CHECK(ret == 12);
+	}
+}
+
+static void TestVariadicPromotions() {
+	FunctionProto proto = ParseProto("int snprintf(char* buf, uint64_t n, const char* fmt, ...)");
+	std::vector<std::shared_ptr<const Type>> variadic = {
+		ParseType("float"), ParseType("char"), ParseType("unsigned short"), ParseType("int8_t"), ParseType("double"), ParseType("long"),
+	};
+	CallPlan plan = CompileCallPlan(proto, Abi::SysV_x64, variadic).GetOk();
+	CHECK(plan.steps[3].load == CallPlan::Load::F64);
+	CHECK(plan.steps[4].load == CallPlan::Load::I32);
+	CHECK(plan.steps[5].load == CallPlan::Load::I32);
+	CHECK(plan.steps[6].load == CallPlan::Load::I32);
+	CHECK(plan.steps[7].load == CallPlan::Load::F64);
+	CHECK(plan.steps[8].load == CallPlan::Load::I64);
+
+	// Win32 passes everything on the stack, where a promoted float takes two slots
+	CallPlan win32 = CompileCallPlan(proto, Abi::Win32, variadic).GetOk();
+	CHECK(win32.steps[3].load == CallPlan::Load::F64);
+	CHECK(win32.stack_slots == 1 + 2 + 1 + 2 + 1 + 1 + 1 + 2 + 1);
+
+	CHECK(!CompileCallPlan(ParseProto("int f(int a)"), Abi::SysV_x64, { ParseType("int") }));
+
+	if (CanInvoke(plan)) {
+		char out[128] = {};
+		ArgPacker args(plan);
+		args << (char*)out << (uint64_t)sizeof(out) << (const char*)"%f %d %d %d %g %ld"
+			<< (double)1.5f << (int)(char)-5 << (int)(unsigned short)60000 << (int)(int8_t)-9 << 0.25 << 123456789012L;
+		int ret = 0;
+		CHECK(Invoke(plan, (void (*)())&std::snprintf, args.Data(), &ret));
+		CHECK(std::strcmp(out, "1.500000 -5 60000 -9 0.25 123456789012") == 0);
+		CHECK(ret == (int)std::strlen(out));
+	}
+
+	// Enough variadic arguments to spill both register classes to the stack
+	std::vector<std::shared_ptr<const Type>> many;
+	for (size_t i = 0; i < 5; ++i)
+		many.push_back(ParseType("int"));
+	for (size_t i = 0; i < 10; ++i)
+		many.push_back(ParseType("float"));
+	CallPlan spilled = CompileCallPlan(proto, Abi::SysV_x64, many).GetOk();
+	CHECK(spilled.int_regs_used == 6);
+	CHECK(spilled.vec_regs_used == 8);
+	CHECK(spilled.stack_slots == 2 + 2);
+
+	if (CanInvoke(spilled)) {
+		char out[256] = {};
+		ArgPacker args(spilled);
+		args << (char*)out << (uint64_t)sizeof(out) << (const char*)"%d %d %d %d %d|%g %g %g %g %g %g %g %g %g %g";
+		for (int i = 1; i <= 5; ++i)
+			args << i;
+		for (int i = 0; i < 10; ++i)
+			args << (double)(i + 0.5f);
+		int ret = 0;
+		CHECK(Invoke(spilled, (void (*)())&std::snprintf, args.Data(), &ret));
+		CHECK(std::strcmp(out, "1 2 3 4 5|0.5 1.5 2.5 3.5 4.5 5.5 6.5 7.5 8.5 9.5") == 0);
+	}
+}
+
+int main() {
+	TestRegisterOverflow();
+	TestMixedArgs();
+	TestVariadicPromotions();
+
+	if (Failures() != 0) {
+		std::fprintf(stderr, "%d checks failed\n", Failures());
+		return 1;
+	}
+	std::printf("callplan: ok\n");
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+#include <cdecl/c/context.hpp>
+#include <cdecl/c/lexer.hpp>
+#include <cdecl/c/syntax.hpp>
+#include <cdecl/c/type.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+// Reports a failed condition and keeps going, so one run shows every failure
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+			++Cdecl::Test::Failures(); \
+		} \
+	} while (0)
+
+namespace Cdecl::Test {
+	inline int& Failures() {
+		static int failures = 0;
+		return failures;
+	}
+
+	// Parses source text that the test itself wrote, so any error is a bug in the test
+	inline TokenBuffer Tokenize(const string& source) {
+		Lexer::ParseBufferResult result = Lexer::ParseBuffer(source);
+		if (!result) {
+			std::fprintf(stderr, "Failed to tokenize '%s'\n", source.c_str());
+			std::exit(2);
+		}
+		return result.TakeOk();
+	}
+
+	/*
+	 * The source is copied and freed before these return, so a parsed node that still views it is caught
+	 * under AddressSanitizer.
+	 */
+	inline FunctionProto ParseProto(const char* source, const ParseContext& ctx = ParseContext()) {
+		string copy = source;
+		TokenBuffer tokens = Tokenize(copy);
+		FunctionProto::ParseResult result = FunctionProto::Parse(TokenCursor(tokens), ctx);
+		if (!result) {
+			std::fprintf(stderr, "Failed to parse '%s': %s\n", source, result.GetErr().Render(tokens).c_str());
+			std::exit(2);
+		}
+		return std::get<FunctionProto>(result.GetOk());
+	}
+
+	inline std::shared_ptr<const Type> ParseType(const char* source, const ParseContext& ctx = ParseContext()) {
+		string copy = source;
+		TokenBuffer tokens = Tokenize(copy);
+		Type::ParseResult result = Type::Parse(TokenCursor(tokens), ParseMaskBlacklist(), ctx);
+		if (!result) {
+			std::fprintf(stderr, "Failed to parse '%s': %s\n", source, result.GetErr().Render(tokens).c_str());
+			std::exit(2);
+		}
+		return std::get<std::shared_ptr<const Type>>(result.GetOk());
+	}
+}
\ No newline at end of file
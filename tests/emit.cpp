@@ -0,0 +1,145 @@
+#include <cdecl/c/emit.hpp>
+#include <cdecl/c/tagtable.hpp>
+#include <vector>
+#include "check.hpp"
+
+using namespace Cdecl;
+using namespace Cdecl::Test;
+
+static string Emit(const FunctionProto& proto) {
+	string out;
+	EmitFunctionProto(proto, out);
+	return out;
+}
+
+static string Emit(const Type& type) {
+	string out;
+	EmitType(type, out);
+	return out;
+}
+
+// Parses, emits and parses again, expecting an equal prototype and, optionally, the canonical text
+static void CheckRoundTrip(const char* source, const char* expected = nullptr) {
+	FunctionProto proto = ParseProto(source);
+	string emitted = Emit(proto);
+	if (expected && emitted != expected)
+		std::fprintf(stderr, "'%s' emitted as '%s', expected '%s'\n", source, emitted.c_str(), expected);
+	CHECK(!expected || emitted == expected);
+
+	FunctionProto parsed = ParseProto(emitted.c_str());
+	CHECK(parsed == proto);
+	CHECK(Emit(parsed) == emitted);
+}
+
+static void TestQualifiers() {
+	CheckRoundTrip("const char* strchr(const char* s, int c)");
+	CheckRoundTrip("char const * f(char const * const p)", "const char* f(const char* const p)");
+	CheckRoundTrip(
+		"volatile const char * const * volatile g(void * const volatile p)",
+		"const volatile char* const* volatile g(void* const volatile p)"
+	);
+	CheckRoundTrip("void h(const int, volatile char**)", "void h(const int, volatile char**)");
+}
+
+static void TestCallConventions() {
+	CheckRoundTrip("int __stdcall MessageBox(void* hwnd, const char* text)");
+	CheckRoundTrip("void __fastcall f(void)", "void __fastcall f()");
+
+	// A convention on a pointer level stays on that level
+	CheckRoundTrip("void* __stdcall * f(int __fastcall * p)", "void* __stdcall* f(int __fastcall* p)");
+	CheckRoundTrip("char __cdecl * __stdcall * g(void)", "char __cdecl* __stdcall* g()");
+	CheckRoundTrip("int __vectorcall v(char* const __thiscall * p)", "int __vectorcall v(char* const __thiscall* p)");
+
+	FunctionProto plain = ParseProto("void* f(void)");
+	CHECK(plain != ParseProto("void* __stdcall f(void)"));
+	CHECK(plain != ParseProto("void __stdcall * f(void)"));
+	CHECK(ParseProto("void* __stdcall f(void)") != ParseProto("void __stdcall * f(void)"));
+}
+
+static void TestIntegers() {
+	CheckRoundTrip(
+		"unsigned long long f(long long a, unsigned b, unsigned long c, long int d, short int e, signed char g, unsigned short h)",
+		"unsigned long long f(long long a, unsigned int b, unsigned long c, long d, short e, signed char g, unsigned short h)"
+	);
+	CheckRoundTrip("long double g(double a, float b, uint64_t c, int8_t d)");
+	CHECK(ParseProto("unsigned f(void)") == ParseProto("unsigned int f(void)"));
+	CHECK(ParseProto("long f(void)") != ParseProto("long long f(void)"));
+}
+
+static void TestVariadics() {
+	CheckRoundTrip("int printf(const char* format, ...)");
+	CheckRoundTrip("int f(...)", "int f(...)");
+	CheckRoundTrip("void g(int, char*, ...)", "void g(int, char*, ...)");
+	CHECK(ParseProto("int f(int a)") != ParseProto("int f(int a, ...)"));
+}
+
+static void TestRecords() {
+	// Declarators only name tagged records, so the definitions are emitted separately and re-parsed first
+	TagTable tags;
+	ParseContext ctx;
+	ctx.tags = &tags;
+	std::shared_ptr<const Type> point = ParseType("struct Point { int x; int y; }", ctx);
+	std::shared_ptr<const Type> shape = ParseType(
+		"struct Shape { const struct Point* points; unsigned long count; union { float radius; struct { int w; int h; } size; } extent; }", ctx
+	);
+	FunctionProto proto = ParseProto("struct Shape* Scale(const struct Shape* shape, struct Point origin, union Opaque* data)", ctx);
+
+	string definitions;
+	EmitRecord(*point->GetRecord(), definitions);
+	definitions += "; ";
+	EmitRecord(*shape->GetRecord(), definitions);
+	CHECK(definitions ==
+		"struct Point { int x; int y; }; "
+		"struct Shape { const struct Point* points; unsigned long count; union { float radius; struct { int w; int h; } size; } extent; }"
+	);
+	string emitted = Emit(proto);
+	CHECK(emitted == "struct Shape* Scale(const struct Shape* shape, struct Point origin, union Opaque* data)");
+
+	TagTable parsed_tags;
+	ParseContext parsed_ctx;
+	parsed_ctx.tags = &parsed_tags;
+	CHECK(*ParseType("struct Point { int x; int y; }", parsed_ctx) == *point);
+	CHECK(*ParseType(definitions.substr(definitions.find("struct Shape")).c_str(), parsed_ctx) == *shape);
+	FunctionProto parsed = ParseProto(emitted.c_str(), parsed_ctx);
+	CHECK(parsed == proto);
+	CHECK(parsed.GetArgs()[1].GetVar().GetType()->GetRecord()->GetLayout(Abi::SysV_x64)->size == 8);
+
+	// Without the definitions, the same text gives incomplete records instead
+	CHECK(ParseProto(emitted.c_str()) != proto);
+
+	// Anonymous records have no tag to refer to, so they are written inline
+	std::shared_ptr<const Type> anon = ParseType("const struct { int x; union { float f; char* s; } u; }* volatile");
+	CHECK(Emit(*anon) == "const struct { int x; union { float f; char* s; } u; }* volatile");
+	CHECK(*ParseType(Emit(*anon).c_str()) == *anon);
+}
+
+static void TestBatch() {
+	std::vector<FunctionProto> protos = { ParseProto("int a(void)"), ParseProto("void* __stdcall b(const char* s, ...)") };
+	string out = "// header\n";
+	EmitFunctionProtos(protos, out);
+	CHECK(out == "// header\nint a();\nvoid* __stdcall b(const char* s, ...);\n");
+
+	out.clear();
+	EmitFunctionProtos(protos, out, ", ");
+	CHECK(out == "int a(), void* __stdcall b(const char* s, ...), ");
+
+	string var;
+	EmitVariable(protos[1].GetArgs()[0].GetVar(), var);
+	CHECK(var == "const char* s");
+}
+
+int main() {
+	TestQualifiers();
+	TestCallConventions();
+	TestIntegers();
+	TestVariadics();
+	TestRecords();
+	TestBatch();
+
+	if (Failures() != 0) {
+		std::fprintf(stderr, "%d checks failed\n", Failures());
+		return 1;
+	}
+	std::printf("emit: ok\n");
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,199 @@
+#include <cdecl/c/record.hpp>
+#include <cdecl/c/tagtable.hpp>
+#include <cdecl/arena.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "check.hpp"
+
+using namespace Cdecl;
+using namespace Cdecl::Test;
+
+// Declares a record for the host compiler along with its source text, so both sides lay out the same declaration
+#define HOST_RECORD(kind, tag, body) \
+	kind tag body; \
+	static const char* const tag##_source = #kind " " #tag " " #body
+
+#if defined(_WIN64)
+static const std::optional<Abi> host_abi = Abi::Win64;
+#elif defined(__x86_64__) && !defined(_WIN32)
+static const std::optional<Abi> host_abi = Abi::SysV_x64;
+#else
+static const std::optional<Abi> host_abi;
+#endif
+
+HOST_RECORD(struct, Basic, { char c; int i; short s; double d; char* p; });
+HOST_RECORD(struct, Widths, { char c; long l; long double ld; long long ll; unsigned short us; });
+HOST_RECORD(union, Mixed, { char c; double d; int i; char* p; });
+HOST_RECORD(struct, Outer, { char c; struct Inner { char a; double d; } inner; short s; union Value { int i; long long ll; } value; });
+HOST_RECORD(struct, Empty, { });
+
+#pragma pack(push, 1)
+HOST_RECORD(struct, Packed1, { char c; int i; double d; short s; });
+#pragma pack(pop)
+#pragma pack(push, 2)
+HOST_RECORD(struct, Packed2, { char c; int i; double d; char e; });
+#pragma pack(pop)
+
+static const RecordLayout* GetLayout(const std::shared_ptr<const Type>& type, Abi abi) {
+	CHECK(type->IsRecord());
+	return type->IsRecord() ? type->GetRecord()->GetLayout(abi) : nullptr;
+}
+
+// Compares a parsed record's layout for the host ABI with the host compiler's, if it is one we model
+template <class T>
+static void CheckHost(const char* source, const std::vector<uint64_t>& offsets, const ParseContext& ctx = ParseContext()) {
+	std::shared_ptr<const Type> type = ParseType(source, ctx);
+	if (!host_abi.has_value())
+		return;
+
+	const RecordLayout* layout = GetLayout(type, host_abi.value());
+	CHECK(layout);
+	if (!layout)
+		return;
+	CHECK(layout->size == sizeof(T));
+	CHECK(layout->align == alignof(T));
+	CHECK(layout->offsets == offsets);
+}
+
+static void TestHostLayouts() {
+	CheckHost<Basic>(Basic_source, { offsetof(Basic, c), offsetof(Basic, i), offsetof(Basic, s), offsetof(Basic, d), offsetof(Basic, p) });
+	CheckHost<Widths>(Widths_source, { offsetof(Widths, c), offsetof(Widths, l), offsetof(Widths, ld), offsetof(Widths, ll), offsetof(Widths, us) });
+	CheckHost<Mixed>(Mixed_source, { 0, 0, 0, 0 });
+	CheckHost<Outer>(Outer_source, { offsetof(Outer, c), offsetof(Outer, inner), offsetof(Outer, s), offsetof(Outer, value) });
+	CheckHost<Outer::Inner>("struct Inner { char a; double d; }", { offsetof(Outer::Inner, a), offsetof(Outer::Inner, d) });
+
+	ParseContext pack1;
+	pack1.pack = 1;
+	CheckHost<Packed1>(Packed1_source, { offsetof(Packed1, c), offsetof(Packed1, i), offsetof(Packed1, d), offsetof(Packed1, s) }, pack1);
+	ParseContext pack2;
+	pack2.pack = 2;
+	CheckHost<Packed2>(Packed2_source, { offsetof(Packed2, c), offsetof(Packed2, i), offsetof(Packed2, d), offsetof(Packed2, e) }, pack2);
+
+	// Empty structs are a GNU C extension, and 0 bytes there. C++ makes them 1 byte, so only the C rule is checked.
+	std::shared_ptr<const Type> empty = ParseType(Empty_source);
+	const RecordLayout* empty_layout = GetLayout(empty, Abi::SysV_x64);
+	CHECK(empty_layout && empty_layout->size == 0 && empty_layout->align == 1 && empty_layout->offsets.empty());
+}
+
+static void TestAbis() {
+	// long is 8 bytes on LP64 and 4 on LLP64. MSVC's long double is a plain double.
+	std::shared_ptr<const Type> type = ParseType("struct { long l; long double ld; char c; char* p; }");
+
+	const RecordLayout* sysv = GetLayout(type, Abi::SysV_x64);
+	CHECK(sysv && sysv->size == 48 && sysv->align == 16);
+	CHECK(sysv && sysv->offsets == std::vector<uint64_t>({ 0, 16, 32, 40 }));
+
+	const RecordLayout* win64 = GetLayout(type, Abi::Win64);
+	CHECK(win64 && win64->size == 32 && win64->align == 8);
+	CHECK(win64 && win64->offsets == std::vector<uint64_t>({ 0, 8, 16, 24 }));
+
+	const RecordLayout* win32 = GetLayout(type, Abi::Win32);
+	CHECK(win32 && win32->size == 24 && win32->align == 8);
+	CHECK(win32 && win32->offsets == std::vector<uint64_t>({ 0, 8, 16, 20 }));
+
+	// Scalar layouts directly
+	CHECK(GetTypeLayout(*ParseType("unsigned long"), Abi::SysV_x64)->size == 8);
+	CHECK(GetTypeLayout(*ParseType("unsigned long"), Abi::Win64)->size == 4);
+	CHECK(GetTypeLayout(*ParseType("long double"), Abi::SysV_x64)->align == 16);
+	CHECK(GetTypeLayout(*ParseType("long double"), Abi::Win64)->align == 8);
+	CHECK(!GetTypeLayout(*ParseType("void"), Abi::SysV_x64));
+}
+
+static void TestMembers() {
+	std::shared_ptr<const Type> type = ParseType("struct Point { int x; int y; union { float f; char* s; } extra; }");
+	const Record& record = *type->GetRecord();
+	CHECK(record.GetTag() == "Point");
+	CHECK(record.GetMembers().size() == 3);
+	CHECK(record.FindMember("y") == std::optional<size_t>(1));
+	CHECK(!record.FindMember("z"));
+	CHECK(record.GetOffset("extra", Abi::SysV_x64) == std::optional<uint64_t>(8));
+	CHECK(record.GetOffset("extra", Abi::Win32) == std::optional<uint64_t>(8));
+	CHECK(!record.GetOffset("z", Abi::SysV_x64));
+
+	// The nested union is anonymous, and a union of its own
+	const Record& extra = *record.GetMembers()[2].GetType()->GetRecord();
+	CHECK(extra.GetTag().empty() && extra.IsUnion());
+	CHECK(extra.GetLayout(Abi::SysV_x64)->size == 8);
+	CHECK(extra.GetLayout(Abi::Win32)->size == 4);
+
+	// A record without a member list has no layout, and neither does one containing it
+	std::shared_ptr<const Type> incomplete = ParseType("struct Opaque");
+	CHECK(!incomplete->GetRecord()->IsComplete());
+	CHECK(!incomplete->GetRecord()->GetLayout(Abi::SysV_x64));
+	CHECK(!GetLayout(ParseType("struct { int i; struct Opaque o; }"), Abi::SysV_x64));
+	CHECK(GetLayout(ParseType("struct { int i; struct Opaque* o; }"), Abi::SysV_x64));
+
+	// Packing is part of a record's identity
+	ParseContext pack1;
+	pack1.pack = 1;
+	CHECK(*ParseType("struct { char c; int i; }") == *ParseType("struct { char c; int i; }"));
+	CHECK(*ParseType("struct { char c; int i; }") != *ParseType("struct { char c; int i; }", pack1));
+}
+
+// Parses source expecting an error, and returns its code
+static std::optional<ErrorCode> ParseTypeError(const char* source, const ParseContext& ctx) {
+	string copy = source;
+	TokenBuffer tokens = Tokenize(copy);
+	Type::ParseResult result = Type::Parse(TokenCursor(tokens), ParseMaskBlacklist(), ctx);
+	if (result)
+		return {};
+	return result.GetErr().code;
+}
+
+static void TestTagTable() {
+	TagTable tags;
+	Arena arena;
+	ParseContext ctx;
+	ctx.tags = &tags;
+	ctx.arena = &arena;
+
+	// References before the definition stay incomplete
+	std::shared_ptr<const Type> early = ParseType("struct Node*", ctx);
+	CHECK(!early->GetPointedType()->GetRecord()->IsComplete());
+	CHECK(tags.Size() == 0);
+
+	ParseType("struct Node { int value; struct Node* next; }", ctx);
+	CHECK(tags.Size() == 1);
+	std::shared_ptr<const Record> node = tags.Find("Node");
+	CHECK(node && node->IsComplete());
+
+	// The definition lives in the table, not the arena it was parsed with
+	arena.Reset();
+	std::shared_ptr<const Type> later = ParseType("struct Node*", ctx);
+	CHECK(later->GetPointedType()->GetRecord() == node);
+	CHECK(node->GetLayout(Abi::SysV_x64)->size == 16);
+	CHECK(node->GetMembers()[0].GetName() == "value");
+
+	// A different body, or a union with the same tag, is a redefinition
+	CHECK(ParseTypeError("struct Node { long value; struct Node* next; }", ctx) == ErrorCode::TagRedefinition);
+	CHECK(ParseTypeError("union Node u", ctx) == ErrorCode::TagRedefinition);
+	CHECK(tags.Size() == 1);
+	CHECK(tags.Find("Node") == node);
+
+	// An identical one is allowed
+	ParseType("union Value { int i; float f; }", ctx);
+	std::shared_ptr<const Record> value = tags.Find("Value");
+	CHECK(value && value->IsUnion());
+	CHECK(!ParseTypeError("union Value { int i; float f; }", ctx));
+	CHECK(ParseTypeError("union Value { int i; double f; }", ctx) == ErrorCode::TagRedefinition);
+	CHECK(ParseTypeError("struct Value { int i; float f; }", ctx) == ErrorCode::TagRedefinition);
+	CHECK(tags.Size() == 2);
+	CHECK(tags.Find("Value") == value);
+	CHECK(!tags.Find("Missing"));
+}
+
+int main() {
+	TestHostLayouts();
+	TestAbis();
+	TestMembers();
+	TestTagTable();
+
+	if (Failures() != 0) {
+		std::fprintf(stderr, "%d checks failed\n", Failures());
+		return 1;
+	}
+	std::printf("record: ok\n");
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include <cdecl/c/thunk.hpp>
+#include <cstdlib>
+#include <cstring>
+#include "check.hpp"
+
+using namespace Cdecl;
+using namespace Cdecl::Test;
+
+// Reads callback arguments at the offsets the thunk's plan packed them at
+class ArgReader {
+	const unsigned char* m_args;
+	const CallPlan& m_plan;
+
+public:
+	ArgReader(const void* args, const CallPlan& plan) : m_args((const unsigned char*)args), m_plan(plan) {}
+
+	template <class T>
+	T Get(size_t index) const {
+		T value;
+		std::memcpy(&value, m_args + m_plan.arg_offsets[index], sizeof(T));
+		return value;
+	}
+};
+
+template <class T>
+static void SetReturn(void* ret, T value) {
+	std::memcpy(ret, &value, sizeof(T));
+}
+
+static void TestIntArgs(ThunkAllocator& thunks) {
+	FunctionProto proto = ParseProto("int Compare(const void* a, const void* b)");
+	CallPlan plan = CompileCallPlan(proto, Abi::SysV_x64).GetOk();
+
+	ThunkAllocator::CreateResult thunk = thunks.Create(proto, [&](const void* args, void* ret) {
+		ArgReader reader(args, plan);
+		SetReturn(ret, *reader.Get<const int*>(0) - *reader.Get<const int*>(1));
+	});
+	CHECK(thunk);
+
+	using Fn = int (*)(const void*, const void*);
+	int a = 5, b = 9;
+	CHECK(((Fn)thunk.GetOk())(&a, &b) == -4);
+	CHECK(((Fn)thunk.GetOk())(&b, &a) == 4);
+
+	// Called back from C
+	int values[] = { 5, 3, 9, 1, 7, -2 };
+	std::qsort(values, sizeof(values) / sizeof(values[0]), sizeof(int), (Fn)thunk.GetOk());
+	for (size_t i = 1; i < sizeof(values) / sizeof(values[0]); ++i)
+		CHECK(values[i - 1] < values[i]);
+}
+
+static void TestFloatArgs(ThunkAllocator& thunks) {
+	FunctionProto proto = ParseProto("float Scale(float a, double b, int8_t c)");
+	CallPlan plan = CompileCallPlan(proto, Abi::SysV_x64).GetOk();
+
+	ThunkAllocator::CreateResult thunk = thunks.Create(proto, [&](const void* args, void* ret) {
+		ArgReader reader(args, plan);
+		SetReturn(ret, (float)(reader.Get<float>(0) * reader.Get<double>(1) + reader.Get<int8_t>(2)));
+	});
+	CHECK(thunk);
+
+	using Fn = float (*)(float, double, int8_t);
+	CHECK(((Fn)thunk.GetOk())(2.5f, 4.0, -3) == 7.0f);
+	CHECK(((Fn)thunk.GetOk())(-0.5f, 0.5, 100) == 99.75f);
+}
+
+// More of each register class than the ABI has, so the rest arrive on the stack
+static void TestStackArgs(ThunkAllocator& thunks) {
+	FunctionProto proto = ParseProto(
+		"double Spill(int32_t a, double b, float c, char d, int64_t e, int64_t f, int64_t g, int64_t h, int16_t i, "
+		"double j, double k, double l, double m, double n, double o, float p, double q)"
+	);
+	CallPlan plan = CompileCallPlan(proto, Abi::SysV_x64).GetOk();
+	CHECK(plan.stack_slots == 3);
+
+	ThunkAllocator::CreateResult thunk = thunks.Create(proto, [&](const void* args, void* ret) {
+		ArgReader reader(args, plan);
+		CHECK(reader.Get<int32_t>(0) == -1);
+		CHECK(reader.Get<double>(1) == 2.5);
+		CHECK(reader.Get<float>(2) == 3.25f);
+		CHECK(reader.Get<char>(3) == 'x');
+		for (size_t i = 4; i < 8; ++i)
+			CHECK(reader.Get<int64_t>(i) == (int64_t)i * 1000000000000);
+		CHECK(reader.Get<int16_t>(8) == -32000);
+		for (size_t i = 9; i < 15; ++i)
+			CHECK(reader.Get<double>(i) == i + 0.5);
+		CHECK(reader.Get<float>(15) == -15.5f);
+		CHECK(reader.Get<double>(16) == 16.5);
+		SetReturn(ret, reader.Get<double>(16) + reader.Get<int16_t>(8));
+	});
+	CHECK(thunk);
+
+	using Fn = double (*)(int32_t, double, float, char, int64_t, int64_t, int64_t, int64_t, int16_t,
+		double, double, double, double, double, double, float, double);
+	double ret = ((Fn)thunk.GetOk())(
+		-1, 2.5, 3.25f, 'x', 4000000000000, 5000000000000, 6000000000000, 7000000000000, -32000,
+		9.5, 10.5, 11.5, 12.5, 13.5, 14.5, -15.5f, 16.5
+	);
+	CHECK(ret == 16.5 - 32000);
+}
+
+static void TestFreeAndReuse(ThunkAllocator& thunks) {
+	FunctionProto proto = ParseProto("int32_t Id(void)");
+	using Fn = int32_t (*)();
+
+	size_t live = thunks.Size();
+	std::vector<ThunkAllocator::Thunk> created;
+	for (int32_t i = 0; i < 600; ++i) { // Spans more than one page
+		ThunkAllocator::CreateResult thunk = thunks.Create(proto, [i](const void*, void* ret) { SetReturn(ret, i); });
+		CHECK(thunk);
+		created.push_back(thunk.GetOk());
+	}
+	CHECK(thunks.Size() == live + 600);
+	for (int32_t i = 0; i < 600; i += 37)
+		CHECK(((Fn)created[i])() == i);
+
+	thunks.Free(created[100]);
+	thunks.Free(created[100]); // Freeing twice is ignored
+	CHECK(thunks.Size() == live + 599);
+
+	ThunkAllocator::CreateResult reused = thunks.Create(proto, [](const void*, void* ret) { SetReturn(ret, (int32_t)-100); });
+	CHECK(reused && reused.GetOk() == created[100]);
+	CHECK(((Fn)created[100])() == -100);
+	CHECK(((Fn)created[101])() == 101);
+
+	for (ThunkAllocator::Thunk thunk : created)
+		thunks.Free(thunk);
+	CHECK(thunks.Size() == live);
+}
+
+int main() {
+	ThunkAllocator thunks;
+
+	if (!CanInvoke(CompileCallPlan(ParseProto("void f(void)"), Abi::SysV_x64).GetOk())) {
+		CHECK(!thunks.Create(ParseProto("void f(void)"), [](const void*, void*) {}));
+		std::printf("thunk: skipped, thunks need an x86-64 SysV host\n");
+		return Failures() != 0;
+	}
+
+	TestIntArgs(thunks);
+	TestFloatArgs(thunks);
+	TestStackArgs(thunks);
+	TestFreeAndReuse(thunks);
+
+	if (Failures() != 0) {
+		std::fprintf(stderr, "%d checks failed\n", Failures());
+		return 1;
+	}
+	std::printf("thunk: ok\n");
+	return 0;
+}
\ No newline at end of file
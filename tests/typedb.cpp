@@ -0,0 +1,223 @@
+#include <cdecl/c/typedb.hpp>
+#include <cdecl/c/tagtable.hpp>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include "check.hpp"
+
+using namespace Cdecl;
+using namespace Cdecl::Test;
+
+static std::vector<unsigned char> Write(std::initializer_list<const char*> sources) {
+	TypeDbWriter writer;
+	for (const char* source : sources)
+		writer.Add(ParseProto(source));
+	return writer.Finish();
+}
+
+static std::shared_ptr<const TypeDb> Load(std::vector<unsigned char> data) {
+	TypeDb::OpenResult db = TypeDb::Load(std::move(data));
+	if (!db) {
+		std::fprintf(stderr, "Failed to load a type database: %s\n", db.GetErr().c_str());
+		std::exit(2);
+	}
+	return db.GetOk();
+}
+
+// Returns the error from loading data, or an empty string if it loaded
+static string LoadError(std::vector<unsigned char> data, bool verify = true) {
+	TypeDb::OpenResult db = TypeDb::Load(std::move(data), verify);
+	return db ? string() : db.GetErr();
+}
+
+template <class T>
+static T Read(const std::vector<unsigned char>& data, size_t offset) {
+	T value;
+	std::memcpy(&value, data.data() + offset, sizeof(T));
+	return value;
+}
+
+template <class T>
+static void Overwrite(std::vector<unsigned char>& data, size_t offset, const T& value) {
+	std::memcpy(data.data() + offset, &value, sizeof(T));
+}
+
+// Stores the checksum of the data as it is now, so only the deeper checks can reject it
+static void Reseal(std::vector<unsigned char>& data) {
+	Overwrite(data, offsetof(TypeDbFormat::Header, checksum), TypeDbFormat::Checksum(data.data(), data.size()));
+}
+
+static void TestRoundTrip() {
+	// Arguments can only name a record, so Point's members come from a TagTable
+	TagTable tags;
+	ParseContext ctx;
+	ctx.tags = &tags;
+	ParseType("struct Point { int x; int y; }", ctx);
+
+	TypeDbWriter db_writer;
+	for (const char* source : {
+		"unsigned long __stdcall strlen(const char* s)",
+		"int printf(const char* format, ...)",
+		"void qsort(void* base, uint64_t count, const volatile void*)",
+		"void move(struct Point p, union Value* v)",
+	})
+		db_writer.Add(ParseProto(source, ctx));
+	std::shared_ptr<const TypeDb> db = Load(db_writer.Finish());
+	CHECK(db->ProtoCount() == 4);
+
+	std::optional<TypeDb::ProtoView> len = db->FindProto("strlen");
+	CHECK(len);
+	if (len) {
+		CHECK(len->GetName() == "strlen");
+		CHECK(len->GetConventionOrDefault(CallConvention::Cdecl) == CallConvention::Stdcall);
+		TypeDb::TypeView ret = len->GetReturnType();
+		CHECK(ret.IsPrimitive() && ret.GetPrimitiveType() == Type::Primitive::Int && ret.IsLong() && ret.IsUnsigned());
+
+		CHECK(len->ArgCount() == 1);
+		TypeDb::ArgView s = len->GetArg(0);
+		CHECK(s.IsVariable() && s.GetName() == "s");
+		CHECK(s.GetType().IsPointer() && !s.GetType().IsConst());
+		CHECK(s.GetType().GetPointedType().IsConst());
+		CHECK(s.GetType().GetPointedType().GetPrimitiveType() == Type::Primitive::Char);
+	}
+
+	std::optional<TypeDb::ProtoView> print = db->FindProto("printf");
+	CHECK(print && print->ArgCount() == 2 && print->GetArg(1).IsVariadic());
+	CHECK(print && print->GetConventionOrDefault(CallConvention::Cdecl) == CallConvention::Cdecl);
+
+	std::optional<TypeDb::ProtoView> sort = db->FindProto("qsort");
+	CHECK(sort && sort->ArgCount() == 3);
+	if (sort) {
+		CHECK(sort->GetArg(1).GetType().GetPrimitiveType() == Type::Primitive::Uint64_t);
+		TypeDb::ArgView key = sort->GetArg(2);
+		CHECK(key.IsType() && key.GetName().empty());
+		CHECK(key.GetType().IsPointer() && key.GetType().GetPointedType().IsConst() && key.GetType().GetPointedType().IsVolatile());
+		CHECK(key.GetType().GetPointedType().GetPrimitiveType() == Type::Primitive::Void);
+	}
+
+	std::optional<TypeDb::ProtoView> mover = db->FindProto("move");
+	CHECK(mover && mover->ArgCount() == 2);
+	if (mover) {
+		TypeDb::RecordView point = mover->GetArg(0).GetType().GetRecord();
+		CHECK(point.GetTag() == "Point" && !point.IsUnion() && point.IsComplete());
+		CHECK(point.MemberCount() == 2 && point.GetMemberName(1) == "y");
+		CHECK(point.GetMemberType(1).GetPrimitiveType() == Type::Primitive::Int);
+
+		TypeDb::RecordView value = mover->GetArg(1).GetType().GetPointedType().GetRecord();
+		CHECK(value.GetTag() == "Value" && value.IsUnion() && !value.IsComplete());
+	}
+
+	// Through a file as well
+	const char* path = "cdecl_test_typedb.bin";
+	TypeDbWriter writer;
+	writer.Add(ParseProto("int puts(const char* s)"));
+	CHECK(!writer.Save(path).has_value());
+	{
+		TypeDb::OpenResult opened = TypeDb::Open(path);
+		CHECK(opened);
+		if (opened)
+			CHECK(opened.GetOk()->FindProto("puts") && opened.GetOk()->FindProto("puts")->GetArg(0).GetName() == "s");
+	}
+	std::remove(path);
+}
+
+static void TestDedup() {
+	size_t one = Load(Write({ "int strlen(const char* s)" }))->TypeCount();
+
+	// Repeating a prototype, or another with the same types, adds no type nodes
+	std::shared_ptr<const TypeDb> db = Load(Write({ "int strlen(const char* s)", "int strlen(const char* s)", "int puts(const char* str)" }));
+	CHECK(db->ProtoCount() == 3);
+	CHECK(db->TypeCount() == one);
+
+	// So equal types share one node
+	TypeDb::TypeView strlen_arg = db->FindProto("strlen")->GetArg(0).GetType();
+	CHECK(strlen_arg.Identity() == db->FindProto("puts")->GetArg(0).GetType().Identity());
+	CHECK(strlen_arg.Identity() != db->FindProto("puts")->GetReturnType().Identity());
+
+	CHECK(Load(Write({ "int strlen(const char* s)", "int f(char* s)" }))->TypeCount() > one);
+
+	// The writer starts over after Finish()
+	TypeDbWriter writer;
+	writer.Add(ParseProto("int strlen(const char* s)"));
+	writer.Finish();
+	writer.Add(ParseProto("void f(void)"));
+	std::shared_ptr<const TypeDb> second = Load(writer.Finish());
+	CHECK(second->ProtoCount() == 1 && !second->FindProto("strlen"));
+}
+
+static void TestFindProto() {
+	std::shared_ptr<const TypeDb> db = Load(Write({ "int c(void)", "int a(void)", "char dup(void)", "int b(void)", "long dup(void)" }));
+
+	// The table is sorted by name, with duplicates in the order they were added
+	const char* names[] = { "a", "b", "c", "dup", "dup" };
+	CHECK(db->ProtoCount() == 5);
+	for (size_t i = 0; i < db->ProtoCount(); ++i)
+		CHECK(db->GetProto(i).GetName() == names[i]);
+	CHECK(db->GetProto(3).GetReturnType().GetPrimitiveType() == Type::Primitive::Char);
+	CHECK(db->GetProto(4).GetReturnType().IsLong());
+
+	for (const char* name : { "a", "b", "c" })
+		CHECK(db->FindProto(name) && db->FindProto(name)->GetName() == name);
+	CHECK(db->FindProto("dup") && db->FindProto("dup")->GetReturnType().GetPrimitiveType() == Type::Primitive::Char);
+
+	for (const char* name : { "", "0", "aa", "ca", "dupe", "z" })
+		CHECK(!db->FindProto(name));
+	CHECK(!Load(Write({}))->FindProto("a"));
+}
+
+static void TestCorruption() {
+	using TypeDbFormat::Header;
+	const std::vector<unsigned char> data = Write({ "int strlen(const char* s)", "void f(struct Foo* x, ...)" });
+	CHECK(LoadError(data).empty());
+
+	std::vector<unsigned char> truncated = data;
+	truncated.resize(data.size() - 4);
+	CHECK(LoadError(truncated) == "Type database is truncated");
+	CHECK(LoadError(truncated, false) == "Type database is truncated");
+	truncated.resize(sizeof(Header) - 1);
+	CHECK(LoadError(truncated) == "Not a type database");
+
+	// Any changed byte, even in the header, fails the checksum
+	std::vector<unsigned char> flipped = data;
+	flipped.back() ^= 1;
+	CHECK(LoadError(flipped) == "Type database checksum mismatch");
+	flipped = data;
+	flipped[offsetof(Header, type_count)] ^= 1;
+	CHECK(LoadError(flipped) == "Type database checksum mismatch");
+
+	std::vector<unsigned char> version = data;
+	Overwrite<uint32_t>(version, offsetof(Header, version), TypeDbFormat::version + 1);
+	CHECK(LoadError(version).find("unsupported") != string::npos);
+
+	// The proto table is bounds checked even without verification
+	std::vector<unsigned char> table = data;
+	Overwrite<uint32_t>(table, offsetof(Header, proto_count), 1000);
+	Reseal(table);
+	CHECK(LoadError(table, false) == "Type database proto table is out of bounds");
+
+	// A node behind the table pointing out of the file, with a checksum that still matches
+	size_t table_pos = offsetof(Header, protos) + Read<int32_t>(data, offsetof(Header, protos));
+	size_t proto_pos = table_pos + Read<int32_t>(data, table_pos);
+	size_t ret_pos = proto_pos + offsetof(TypeDbFormat::ProtoNode, ret);
+	for (int32_t rel : { (int32_t)data.size(), -(int32_t)ret_pos, 2 }) {
+		std::vector<unsigned char> bad_ref = data;
+		Overwrite(bad_ref, ret_pos, TypeDbFormat::Ref{ rel });
+		Reseal(bad_ref);
+		CHECK(LoadError(bad_ref) == "Type database has a reference out of bounds");
+	}
+}
+
+int main() {
+	TestRoundTrip();
+	TestDedup();
+	TestFindProto();
+	TestCorruption();
+
+	if (Failures() != 0) {
+		std::fprintf(stderr, "%d checks failed\n", Failures());
+		return 1;
+	}
+	std::printf("typedb: ok\n");
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include <cdecl/c/typedeftable.hpp>
+#include <string>
+#include "check.hpp"
+
+using namespace Cdecl;
+using namespace Cdecl::Test;
+
+// Defines `typedef <source>`. The text is freed on return, so the returned name must be the table's own copy.
+static TypedefTable::ParseResult Typedef(TypedefTable& typedefs, const char* source, const ParseContext& ctx = ParseContext()) {
+	string text = string("typedef ") + source;
+	TokenBuffer tokens = Tokenize(text);
+	TypedefTable::ParseResult result = typedefs.ParseTypedef(TokenCursor(tokens), ctx);
+	if (result)
+		CHECK(std::get<TokenCursor>(result.GetOk()).Pos() == tokens.Size());
+	return result;
+}
+
+static void TestDefineFind() {
+	TypedefTable typedefs;
+	CHECK(typedefs.Size() == 0);
+	CHECK(!typedefs.Find("DWORD"));
+
+	std::shared_ptr<const Type> dword = ParseType("unsigned long");
+	CHECK(typedefs.Define("DWORD", dword));
+	CHECK(typedefs.Size() == 1);
+	CHECK(typedefs.Find("DWORD") && *typedefs.Find("DWORD") == *dword);
+	CHECK(!typedefs.Find("DWORD64"));
+	CHECK(!typedefs.Find("dword"));
+
+	// Found types are canonical, so every lookup hands out the same node
+	CHECK(typedefs.Find("DWORD") == typedefs.Find("DWORD"));
+}
+
+static void TestRedefinition() {
+	TypedefTable typedefs;
+	CHECK(Typedef(typedefs, "unsigned long DWORD"));
+
+	// Repeating an identical typedef is fine, even from a separately parsed node
+	CHECK(Typedef(typedefs, "unsigned long DWORD"));
+	CHECK(typedefs.Define("DWORD", ParseType("unsigned long")));
+	CHECK(typedefs.Size() == 1);
+
+	TypedefTable::ParseResult conflict = Typedef(typedefs, "unsigned int DWORD");
+	CHECK(!conflict);
+	if (!conflict) {
+		CHECK(conflict.GetErr().code == ErrorCode::TypedefRedefinition);
+		CHECK(conflict.GetErr().pos == 3);
+	}
+	CHECK(!typedefs.Define("DWORD", ParseType("long")));
+	CHECK(typedefs.Size() == 1);
+	CHECK(*typedefs.Find("DWORD") == *ParseType("unsigned long"));
+}
+
+static void TestParseTypedef() {
+	TypedefTable typedefs;
+
+	TypedefTable::ParseResult result = Typedef(typedefs, "const char* LPCSTR");
+	CHECK(result);
+	if (result)
+		CHECK(std::get<string_view>(result.GetOk()) == "LPCSTR");
+	CHECK(*typedefs.Find("LPCSTR") == *ParseType("const char*"));
+
+	// A typedef's type may name an earlier typedef once the table is in the context
+	ParseContext ctx;
+	ctx.typedefs = &typedefs;
+	CHECK(Typedef(typedefs, "unsigned char BYTE"));
+	CHECK(Typedef(typedefs, "BYTE* PBYTE", ctx));
+	CHECK(*typedefs.Find("PBYTE") == *ParseType("unsigned char*"));
+
+	string missing_keyword = "int INT";
+	TypedefTable::ParseResult no_keyword = typedefs.ParseTypedef(TokenCursor(Tokenize(missing_keyword)));
+	CHECK(!no_keyword && no_keyword.GetErr().code == ErrorCode::ExpectedTypedef);
+
+	TypedefTable::ParseResult no_name = Typedef(typedefs, "int");
+	CHECK(!no_name && no_name.GetErr().code == ErrorCode::ExpectedIdentifier);
+}
+
+static void TestGrowth() {
+	// Far past the initial capacity, so the table is published again several times
+	TypedefTable typedefs = TypedefTable(4);
+	std::shared_ptr<const Type> types[] = { ParseType("int"), ParseType("char*"), ParseType("unsigned long long") };
+
+	const size_t count = 1000;
+	for (size_t i = 0; i < count; ++i)
+		CHECK(typedefs.Define("T" + std::to_string(i), types[i % 3]));
+	CHECK(typedefs.Size() == count);
+
+	for (size_t i = 0; i < count; ++i) {
+		std::shared_ptr<const Type> found = typedefs.Find("T" + std::to_string(i));
+		CHECK(found && *found == *types[i % 3]);
+	}
+	CHECK(!typedefs.Find("T" + std::to_string(count)));
+}
+
+static void TestQualifiedName() {
+	TypedefTable typedefs;
+	CHECK(Typedef(typedefs, "char* PSTR"));
+	ParseContext ctx;
+	ctx.typedefs = &typedefs;
+
+	// The qualifier applies to the named pointer, not to the char it points to
+	for (const char* source : { "const PSTR", "PSTR const" }) {
+		std::shared_ptr<const Type> type = ParseType(source, ctx);
+		CHECK(type->IsPointer() && type->IsConst());
+		CHECK(!type->GetPointedType()->IsConst());
+		CHECK(*type == *ParseType("char* const"));
+		CHECK(*type != *ParseType("const char*"));
+	}
+
+	// Plain uses keep the typedef's own node
+	FunctionProto proto = ParseProto("PSTR strcpy(PSTR dst, const PSTR src)", ctx);
+	CHECK(proto.GetReturnType() == typedefs.Find("PSTR"));
+	CHECK(proto.GetArgs()[0].GetVar().GetType() == typedefs.Find("PSTR"));
+	CHECK(proto.GetArgs()[1].GetVar().GetType()->IsConst());
+	CHECK(!typedefs.Find("PSTR")->IsConst());
+}
+
+int main() {
+	TestDefineFind();
+	TestRedefinition();
+	TestParseTypedef();
+	TestGrowth();
+	TestQualifiedName();
+
+	if (Failures() != 0) {
+		std::fprintf(stderr, "%d checks failed\n", Failures());
+		return 1;
+	}
+	std::printf("typedeftable: ok\n");
+	return 0;
+}
\ No newline at end of file